@@ -34,6 +34,9 @@ static Cartridge *cartridge = 0;
 static Settings *settings = 0;
 static OSystem osystem;
 static StateManager stateManager(&osystem);
+// The random generator as it was right after loading the game. Stella doesn't
+// save it in states, and it seeds RAM, the RIOT timer and undriven bus bits.
+static Random loadedRandom;
 
 static int videoWidth, videoHeight;
 
@@ -144,11 +147,20 @@ bool retro_serialize(void *data, size_t size)
     return true;
 }
 
+/* Puts back everything a state doesn't cover, such as the TIA sound
+ * generator counters, as it was when the game was loaded */
+static void restore_loaded_state()
+{
+   console->system().randGenerator() = loadedRandom;
+   console->system().reset();
+}
+
 bool retro_unserialize(const void *data, size_t size)
 {
     std::string s((const char*)data, size);
     Serializer state;
     state.set(s);
+   restore_loaded_state();
    if(stateManager.loadState(state))
       return true;
    return false;
@@ -237,6 +249,8 @@ bool retro_load_game(const struct retro_game_info *info)
    videoWidth = tia.width();
    videoHeight = tia.height();
 
+   loadedRandom = console->system().randGenerator();
+
    return true;
 }
 
@@ -315,6 +329,7 @@ void retro_deinit(void)
 
 void retro_reset(void)
 {
+   console->system().randGenerator() = loadedRandom;
    console->system().reset();
 }
 
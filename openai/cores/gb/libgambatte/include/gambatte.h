@@ -108,9 +108,12 @@ public:
 	/** Returns true if a ROM image is loaded. */
 	bool isLoaded() const;
 	
-   void saveState(void *data);
-   void loadState(const void *data);
-   size_t stateSize() const;
+   /** Bulk states are written as raw SaveState blocks rather than labelled fields.
+     * They are faster to save and load but tied to this build's ABI. loadState accepts either kind,
+     * and returns false for states it can't read, such as bulk states from another build. */
+   void saveState(void *data, bool bulk = false);
+   bool loadState(const void *data);
+   size_t stateSize(bool bulk = false) const;
 
    void setColorCorrection(bool enable);
    video_pixel_t gbcToRgb32(const unsigned bgr15);
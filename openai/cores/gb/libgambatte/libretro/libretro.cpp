@@ -291,6 +291,7 @@ void retro_set_environment(retro_environment_t cb)
       { "gambatte_gbc_color_correction", "Color correction; enabled|disabled" },
       { "gambatte_gb_hwmode", "Emulated hardware (restart); Auto|GB|GBC|GBA" },
       { "gambatte_gb_bootloader", "Use official bootloader (restart); enabled|disabled" },
+      { "gambatte_bulk_savestate", "Bulk savestates (same build only); disabled|enabled" },
 #ifdef HAVE_NETWORK
       { "gambatte_gb_link_mode", "GameBoy Link Mode; Not Connected|Network Server|Network Client" },
       { "gambatte_gb_link_network_port", "Network Link Port; 56400|56401|56402|56403|56404|56405|56406|56407|56408|56409|56410|56411|56412|56413|56414|56415|56416|56417|56418|56419|56420" },
@@ -346,32 +347,39 @@ void retro_reset()
    }
 }
 
-static size_t serialize_size = 0;
+// State sizes only depend on the loaded cartridge, so they are computed
+// once per game instead of on every call. Index 1 holds the bulk size.
+static bool bulk_savestate = false;
+static size_t serialize_size[2] = { 0, 0 };
+
+static size_t state_size(bool bulk)
+{
+   if (!serialize_size[bulk])
+      serialize_size[bulk] = gb.stateSize(bulk);
+   return serialize_size[bulk];
+}
+
 size_t retro_serialize_size(void)
 {
-   return gb.stateSize();
+   return state_size(bulk_savestate);
 }
 
 bool retro_serialize(void *data, size_t size)
 {
-   serialize_size = retro_serialize_size();
-
-   if (size != serialize_size)
+   if (size != state_size(bulk_savestate))
       return false;
 
-   gb.saveState(data);
+   gb.saveState(data, bulk_savestate);
    return true;
 }
 
 bool retro_unserialize(const void *data, size_t size)
 {
-   serialize_size = retro_serialize_size();
-
-   if (size != serialize_size)
+   // loadState tells the formats apart, so either kind of state is accepted
+   if (size != state_size(false) && size != state_size(true))
       return false;
 
-   gb.loadState(data);
-   return true;
+   return gb.loadState(data);
 }
 
 void retro_cheat_reset()
@@ -527,6 +535,9 @@ static void check_variables(void)
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "disabled")) colorCorrection=false;
    gb.setColorCorrection(colorCorrection);
 
+   var.key = "gambatte_bulk_savestate";
+   bulk_savestate = environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "enabled");
+
 #ifdef HAVE_NETWORK
    gb_serialMode = SERIAL_NONE;
    var.key = "gambatte_gb_link_mode";
@@ -733,6 +744,8 @@ bool retro_load_game(const struct retro_game_info *info)
       return false;
 #endif
 
+   serialize_size[0] = serialize_size[1] = 0;
+
    rom_path = info->path ? info->path : "";
    strncpy(internal_game_name, (const char*)info->data + 0x134, sizeof(internal_game_name) - 1);
    internal_game_name[sizeof(internal_game_name)-1]='\0';
@@ -126,28 +126,36 @@ void GB::setDmgPaletteColor(unsigned palNum, unsigned colorNum, unsigned rgb32)
 	p_->cpu.setDmgPaletteColor(palNum, colorNum, rgb32);
 }
 
-void GB::loadState(const void *data) {
+bool GB::loadState(const void *data) {
    SaveState state;
    p_->cpu.setStatePtrs(state);
    
-   if (StateSaver::loadState(state, data)) {
-      p_->cpu.loadState(state);
-      p_->cpu.mem_.bootloader.choosebank(state.mem.ioamhram.get()[0x150] != 0xFF);
-   }
+   if (!StateSaver::loadState(state, data))
+      return false;
+   
+   p_->cpu.loadState(state);
+   p_->cpu.mem_.bootloader.choosebank(state.mem.ioamhram.get()[0x150] != 0xFF);
+   return true;
 }
 
-void GB::saveState(void *data) {
+void GB::saveState(void *data, bool bulk) {
    SaveState state;
+   // Bulk states copy struct padding too, so start from a clean slate.
+   std::memset(static_cast<void *>(&state), 0, sizeof state);
    p_->cpu.setStatePtrs(state);
    p_->cpu.saveState(state);
-   StateSaver::saveState(state, data);
+
+   if (bulk)
+      StateSaver::saveBulkState(state, data);
+   else
+      StateSaver::saveState(state, data);
 }
 
-size_t GB::stateSize() const {
+size_t GB::stateSize(bool bulk) const {
    SaveState state;
    p_->cpu.setStatePtrs(state);
    p_->cpu.saveState(state);
-   return StateSaver::stateSize(state);
+   return bulk ? StateSaver::bulkStateSize(state) : StateSaver::stateSize(state);
 }
 
 void GB::setColorCorrection(bool enable) {
@@ -123,6 +123,8 @@ struct Saver {
 	void (*save)(omemstream &file, const SaveState &state);
 	void (*load)(imemstream &file, SaveState &state);
 	unsigned char labelsize;
+	std::size_t offset;
+	std::size_t size;
 };
 
 static inline bool operator<(const Saver &l, const Saver &r) {
@@ -263,29 +265,47 @@ public:
 private:
 	list_t list;
 	unsigned char maxLabelsize_;
+	uint32_t layout_;
 	
 public:
 	SaverList();
 	const_iterator begin() const { return list.begin(); }
 	const_iterator end() const { return list.end(); }
 	unsigned maxLabelsize() const { return maxLabelsize_; }
+	// Hash of where each saved member sits in SaveState, for bulk states
+	uint32_t layout() const { return layout_; }
 };
 
 static void pushSaver(SaverList::list_t &list, const char *label,
 		void (*save)(omemstream &file, const SaveState &state),
-		void (*load)(imemstream &file, SaveState &state), unsigned labelsize) {
-	const Saver saver = { label, save, load, labelsize };
+		void (*load)(imemstream &file, SaveState &state), unsigned labelsize,
+		const SaveState &state, const void *member, std::size_t size) {
+	const std::size_t offset = static_cast<const char *>(member) - reinterpret_cast<const char *>(&state);
+	const Saver saver = { label, save, load, labelsize, offset, size };
 	list.push_back(saver);
 }
 
+static uint32_t fnv1a(uint32_t hash, const void *data, std::size_t size) {
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+	
+	for (std::size_t i = 0; i < size; ++i)
+		hash = (hash ^ bytes[i]) * 0x01000193;
+	
+	return hash;
+}
+
 SaverList::SaverList() {
+	// Only used to take member addresses
+	static SaveState layoutState;
+	
 #define ADD(arg) do { \
 	struct Func { \
 		static void save(omemstream &file, const SaveState &state) { write(file, state.arg); } \
 		static void load(imemstream &file, SaveState &state) { read(file, state.arg); } \
 	}; \
 	\
-	pushSaver(list, label, Func::save, Func::load, sizeof label); \
+	pushSaver(list, label, Func::save, Func::load, sizeof label, \
+			layoutState, &layoutState.arg, sizeof layoutState.arg); \
 } while (0)
 
 #define ADDPTR(arg) do { \
@@ -294,7 +314,8 @@ SaverList::SaverList() {
 		static void load(imemstream &file, SaveState &state) { read(file, state.arg.ptr, state.arg.size()); } \
 	}; \
 	\
-	pushSaver(list, label, Func::save, Func::load, sizeof label); \
+	pushSaver(list, label, Func::save, Func::load, sizeof label, \
+			layoutState, &layoutState.arg, sizeof layoutState.arg); \
 } while (0)
 
 #define ADDARRAY(arg) do { \
@@ -303,7 +324,8 @@ SaverList::SaverList() {
 		static void load(imemstream &file, SaveState &state) { read(file, state.arg, sizeof(state.arg)); } \
 	}; \
 	\
-	pushSaver(list, label, Func::save, Func::load, sizeof label); \
+	pushSaver(list, label, Func::save, Func::load, sizeof label, \
+			layoutState, &layoutState.arg, sizeof layoutState.arg); \
 } while (0)
 	
 	{ static const char label[] = { c,c,           NUL }; ADD(cpu.cycleCounter); }
@@ -433,6 +455,19 @@ SaverList::SaverList() {
 		if (list[i].labelsize > maxLabelsize_)
 			maxLabelsize_ = list[i].labelsize;
 	}
+	
+	// Bulk states copy the blocks whole, so their sizes are part of the
+	// layout along with the offset and size of every saved member.
+	const std::size_t blocks[] = { sizeof(SaveState::CPU), sizeof(SaveState::Mem),
+		sizeof(SaveState::PPU), sizeof(SaveState::SPU), sizeof(SaveState::RTC) };
+	
+	layout_ = fnv1a(0x811C9DC5, blocks, sizeof blocks);
+	
+	for (std::size_t i = 0; i < list.size(); ++i) {
+		layout_ = fnv1a(layout_, list[i].label, list[i].labelsize);
+		layout_ = fnv1a(layout_, &list[i].offset, sizeof list[i].offset);
+		layout_ = fnv1a(layout_, &list[i].size, sizeof list[i].size);
+	}
 }
 
 }
@@ -445,6 +480,88 @@ static void writeSnapShot(omemstream &file) {
 
 static SaverList list;
 
+static const unsigned char bulkVersion = 2;
+
+static void writeBulk(omemstream &file, const SaveState &state) {
+	SaveState::Mem mem;
+	SaveState::PPU ppu;
+	SaveState::SPU spu;
+	
+	// Copy the blocks whole, padding included, and drop the buffer pointers
+	// so the written state does not depend on where the core was loaded.
+	std::memcpy(&mem, &state.mem, sizeof mem);
+	std::memcpy(&ppu, &state.ppu, sizeof ppu);
+	std::memcpy(&spu, &state.spu, sizeof spu);
+	mem.vram = mem.sram = mem.wram = mem.ioamhram = SaveState::Ptr<unsigned char>();
+	ppu.bgpData = ppu.objpData = ppu.oamReaderBuf = SaveState::Ptr<unsigned char>();
+	ppu.oamReaderSzbuf = SaveState::Ptr<bool>();
+	spu.ch3.waveRam = SaveState::Ptr<unsigned char>();
+	
+	// Bulk states are only valid for builds whose SaveState shares this layout.
+	const uint32_t layout = list.layout();
+	
+	file.write(&layout, sizeof layout);
+	file.write(&state.cpu, sizeof state.cpu);
+	file.write(&mem, sizeof mem);
+	file.write(&ppu, sizeof ppu);
+	file.write(&spu, sizeof spu);
+	file.write(&state.rtc, sizeof state.rtc);
+	
+	write(file, state.mem.vram.get(), state.mem.vram.size());
+	write(file, state.mem.sram.get(), state.mem.sram.size());
+	write(file, state.mem.wram.get(), state.mem.wram.size());
+	write(file, state.mem.ioamhram.get(), state.mem.ioamhram.size());
+	write(file, state.ppu.bgpData.get(), state.ppu.bgpData.size());
+	write(file, state.ppu.objpData.get(), state.ppu.objpData.size());
+	write(file, state.ppu.oamReaderBuf.get(), state.ppu.oamReaderBuf.size());
+	write(file, state.ppu.oamReaderSzbuf.get(), state.ppu.oamReaderSzbuf.size());
+	write(file, state.spu.ch3.waveRam.get(), state.spu.ch3.waveRam.size());
+}
+
+static bool readBulk(imemstream &file, SaveState &state) {
+	uint32_t layout;
+	
+	file.read(&layout, sizeof layout);
+	
+	if (layout != list.layout())
+		return false;
+	
+	SaveState::Mem mem;
+	SaveState::PPU ppu;
+	SaveState::SPU spu;
+	
+	file.read(&state.cpu, sizeof state.cpu);
+	file.read(&mem, sizeof mem);
+	file.read(&ppu, sizeof ppu);
+	file.read(&spu, sizeof spu);
+	file.read(&state.rtc, sizeof state.rtc);
+	
+	mem.vram = state.mem.vram;
+	mem.sram = state.mem.sram;
+	mem.wram = state.mem.wram;
+	mem.ioamhram = state.mem.ioamhram;
+	ppu.bgpData = state.ppu.bgpData;
+	ppu.objpData = state.ppu.objpData;
+	ppu.oamReaderBuf = state.ppu.oamReaderBuf;
+	ppu.oamReaderSzbuf = state.ppu.oamReaderSzbuf;
+	spu.ch3.waveRam = state.spu.ch3.waveRam;
+	state.mem = mem;
+	state.ppu = ppu;
+	state.spu = spu;
+	
+	read(file, state.mem.vram.get(), state.mem.vram.size());
+	read(file, state.mem.sram.get(), state.mem.sram.size());
+	read(file, state.mem.wram.get(), state.mem.wram.size());
+	read(file, state.mem.ioamhram.get(), state.mem.ioamhram.size());
+	read(file, state.ppu.bgpData.get(), state.ppu.bgpData.size());
+	read(file, state.ppu.objpData.get(), state.ppu.objpData.size());
+	read(file, state.ppu.oamReaderBuf.get(), state.ppu.oamReaderBuf.size());
+	read(file, state.ppu.oamReaderSzbuf.get(), state.ppu.oamReaderSzbuf.size());
+	read(file, state.spu.ch3.waveRam.get(), state.spu.ch3.waveRam.size());
+	
+	return true;
+}
+
 } // anon namespace
 
 namespace gambatte {
@@ -471,9 +588,12 @@ bool StateSaver::loadState(SaveState &state, const void *data) {
    if (file.fail() || file.get() != 0)
       return false;
 
-   file.ignore();
+   const unsigned char version = file.get();
    file.ignore(get24(file));
 
+   if (version == bulkVersion)
+      return readBulk(file, state);
+
    const Array<char> labelbuf(list.maxLabelsize());
    const Saver labelbufSaver = { labelbuf, 0, 0, list.maxLabelsize() };
 
@@ -521,5 +641,33 @@ size_t StateSaver::stateSize(const SaveState &state) {
    return file.size();
 }
 
+void StateSaver::saveBulkState(const SaveState &state, void *data) {
+   omemstream file(data);
+
+   if (file.fail())
+      return;
+
+   file.put(0);
+   file.put(bulkVersion);
+
+   writeSnapShot(file);
+   writeBulk(file, state);
+}
+
+size_t StateSaver::bulkStateSize(const SaveState &state) {
+   omemstream file(0);
+
+   if (file.fail())
+      return 0;
+
+   file.put(0);
+   file.put(bulkVersion);
+
+   writeSnapShot(file);
+   writeBulk(file, state);
+
+   return file.size();
+}
+
 }
 
@@ -39,6 +39,12 @@ public:
    static void saveState(const SaveState &state, void *data);
    static bool loadState(SaveState &state, const void *data);
    static size_t stateSize(const SaveState &state);
+
+   /* Bulk states copy the SaveState blocks in host layout instead of going
+    * through the labelled per-field list. They are only portable between
+    * builds sharing the same ABI; loadState accepts both kinds. */
+   static void saveBulkState(const SaveState &state, void *data);
+   static size_t bulkStateSize(const SaveState &state);
 };
 
 }
@@ -50,6 +50,19 @@ static inline unsigned clz32(uint32_t bits) {
 #endif
 }
 
+static inline unsigned ctz32(uint32_t bits) {
+#if defined(__GNUC__) || __clang__
+	return __builtin_ctz(bits);
+#else
+	unsigned count = 0;
+	while (!(bits & 1)) {
+		bits >>= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
 static inline uint32_t toPow2(uint32_t bits) {
 	if (!bits) {
 		return 0;
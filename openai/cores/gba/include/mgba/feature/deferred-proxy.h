@@ -0,0 +1,33 @@
+/* Copyright (c) 2013-2017 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#ifndef VIDEO_DEFERRED_PROXY_H
+#define VIDEO_DEFERRED_PROXY_H
+
+#include <mgba-util/common.h>
+
+CXX_GUARD_START
+
+#include "video-logger.h"
+
+// Logs renderer writes into memory instead of drawing them. Nothing reaches
+// the backend until the log is run: with draw set it composes the logged
+// frame, otherwise only the register and memory writes are applied so that
+// a frame nobody looks at costs no scanline rendering.
+struct mVideoDeferredProxy {
+	struct mVideoLogger d;
+
+	uint8_t* buffer;
+	size_t size;
+	size_t capacity;
+	size_t readOffset;
+};
+
+void mVideoDeferredProxyCreate(struct mVideoDeferredProxy* renderer);
+bool mVideoDeferredProxyRun(struct mVideoDeferredProxy* renderer, bool draw);
+
+CXX_GUARD_END
+
+#endif
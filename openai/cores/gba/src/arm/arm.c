@@ -11,6 +11,26 @@
 
 static inline enum RegisterBank _ARMSelectBank(enum PrivilegeMode);
 
+// Bit N of each entry is set if the condition passes when NZCV == N
+static const uint16_t _armConditions[16] = {
+	0xF0F0, // EQ
+	0x0F0F, // NE
+	0xCCCC, // CS
+	0x3333, // CC
+	0xFF00, // MI
+	0x00FF, // PL
+	0xAAAA, // VS
+	0x5555, // VC
+	0x0C0C, // HI
+	0xF3F3, // LS
+	0xAA55, // GE
+	0x55AA, // LT
+	0x0A05, // GT
+	0xF5FA, // LE
+	0xFFFF, // AL
+	0x0000, // NV
+};
+
 void ARMSetPrivilegeMode(struct ARMCore* cpu, enum PrivilegeMode mode) {
 	if (mode == cpu->privilegeMode) {
 		// Not switching modes after all
@@ -216,58 +236,9 @@ static inline void ARMStep(struct ARMCore* cpu) {
 	LOAD_32(cpu->prefetch[1], cpu->gprs[ARM_PC] & cpu->memory.activeMask, cpu->memory.activeRegion);
 
 	unsigned condition = opcode >> 28;
-	if (condition != 0xE) {
-		bool conditionMet = false;
-		switch (condition) {
-		case 0x0:
-			conditionMet = ARM_COND_EQ;
-			break;
-		case 0x1:
-			conditionMet = ARM_COND_NE;
-			break;
-		case 0x2:
-			conditionMet = ARM_COND_CS;
-			break;
-		case 0x3:
-			conditionMet = ARM_COND_CC;
-			break;
-		case 0x4:
-			conditionMet = ARM_COND_MI;
-			break;
-		case 0x5:
-			conditionMet = ARM_COND_PL;
-			break;
-		case 0x6:
-			conditionMet = ARM_COND_VS;
-			break;
-		case 0x7:
-			conditionMet = ARM_COND_VC;
-			break;
-		case 0x8:
-			conditionMet = ARM_COND_HI;
-			break;
-		case 0x9:
-			conditionMet = ARM_COND_LS;
-			break;
-		case 0xA:
-			conditionMet = ARM_COND_GE;
-			break;
-		case 0xB:
-			conditionMet = ARM_COND_LT;
-			break;
-		case 0xC:
-			conditionMet = ARM_COND_GT;
-			break;
-		case 0xD:
-			conditionMet = ARM_COND_LE;
-			break;
-		default:
-			break;
-		}
-		if (!conditionMet) {
-			cpu->cycles += ARM_PREFETCH_CYCLES;
-			return;
-		}
+	if (condition != 0xE && !((_armConditions[condition] >> ((uint32_t) cpu->cpsr.packed >> 28)) & 1)) {
+		cpu->cycles += ARM_PREFETCH_CYCLES;
+		return;
 	}
 	ARMInstruction instruction = _armTable[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0x00F)];
 	instruction(cpu, opcode);
@@ -0,0 +1,108 @@
+/* Copyright (c) 2013-2017 Jeffrey Pfau
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <mgba/feature/deferred-proxy.h>
+
+#define BUFFER_BASE_SIZE 0x20000
+
+static void mVideoDeferredProxyInit(struct mVideoLogger* logger);
+static void mVideoDeferredProxyDeinit(struct mVideoLogger* logger);
+
+static bool _writeData(struct mVideoLogger* logger, const void* data, size_t length);
+static bool _readData(struct mVideoLogger* logger, void* data, size_t length, bool block);
+
+void mVideoDeferredProxyCreate(struct mVideoDeferredProxy* renderer) {
+	mVideoLoggerRendererCreate(&renderer->d, false);
+	renderer->d.block = true;
+
+	renderer->d.init = mVideoDeferredProxyInit;
+	renderer->d.deinit = mVideoDeferredProxyDeinit;
+
+	renderer->d.writeData = _writeData;
+	renderer->d.readData = _readData;
+
+	renderer->buffer = NULL;
+	renderer->size = 0;
+	renderer->capacity = 0;
+	renderer->readOffset = 0;
+}
+
+void mVideoDeferredProxyInit(struct mVideoLogger* logger) {
+	struct mVideoDeferredProxy* proxyRenderer = (struct mVideoDeferredProxy*) logger;
+	proxyRenderer->capacity = BUFFER_BASE_SIZE;
+	proxyRenderer->buffer = malloc(proxyRenderer->capacity);
+	proxyRenderer->size = 0;
+	proxyRenderer->readOffset = 0;
+}
+
+void mVideoDeferredProxyDeinit(struct mVideoLogger* logger) {
+	struct mVideoDeferredProxy* proxyRenderer = (struct mVideoDeferredProxy*) logger;
+	free(proxyRenderer->buffer);
+	proxyRenderer->buffer = NULL;
+	proxyRenderer->size = 0;
+	proxyRenderer->capacity = 0;
+	proxyRenderer->readOffset = 0;
+}
+
+bool mVideoDeferredProxyRun(struct mVideoDeferredProxy* renderer, bool draw) {
+	struct mVideoLoggerDirtyInfo item = {0};
+	bool ok = true;
+	while (ok && renderer->d.readData(&renderer->d, &item, sizeof(item), false)) {
+		switch (item.type) {
+		case DIRTY_SCANLINE:
+		case DIRTY_RANGE:
+			if (draw) {
+				renderer->d.parsePacket(&renderer->d, &item);
+			}
+			break;
+		case DIRTY_FLUSH:
+			break;
+		case DIRTY_REGISTER:
+		case DIRTY_PALETTE:
+		case DIRTY_OAM:
+		case DIRTY_VRAM:
+		case DIRTY_FRAME:
+		case DIRTY_BUFFER:
+			renderer->d.parsePacket(&renderer->d, &item);
+			break;
+		default:
+			ok = false;
+			break;
+		}
+	}
+	renderer->size = 0;
+	renderer->readOffset = 0;
+	return ok;
+}
+
+static bool _writeData(struct mVideoLogger* logger, const void* data, size_t length) {
+	struct mVideoDeferredProxy* proxyRenderer = (struct mVideoDeferredProxy*) logger;
+	if (proxyRenderer->size + length > proxyRenderer->capacity) {
+		size_t capacity = proxyRenderer->capacity ? proxyRenderer->capacity : BUFFER_BASE_SIZE;
+		while (proxyRenderer->size + length > capacity) {
+			capacity *= 2;
+		}
+		uint8_t* buffer = realloc(proxyRenderer->buffer, capacity);
+		if (!buffer) {
+			return false;
+		}
+		proxyRenderer->buffer = buffer;
+		proxyRenderer->capacity = capacity;
+	}
+	memcpy(&proxyRenderer->buffer[proxyRenderer->size], data, length);
+	proxyRenderer->size += length;
+	return true;
+}
+
+static bool _readData(struct mVideoLogger* logger, void* data, size_t length, bool block) {
+	UNUSED(block);
+	struct mVideoDeferredProxy* proxyRenderer = (struct mVideoDeferredProxy*) logger;
+	if (proxyRenderer->readOffset + length > proxyRenderer->size) {
+		return false;
+	}
+	memcpy(data, &proxyRenderer->buffer[proxyRenderer->readOffset], length);
+	proxyRenderer->readOffset += length;
+	return true;
+}
@@ -30,11 +30,13 @@ static const struct mVLDescriptor {
 	enum mPlatform platform;
 	struct mCore* (*open)(void);
 } _descriptors[] = {
+#ifndef MINIMAL_CORE
 #ifdef M_CORE_GBA
 	{ PLATFORM_GBA, GBAVideoLogPlayerCreate },
 #endif
 #ifdef M_CORE_GB
 	{ PLATFORM_GB, GBVideoLogPlayerCreate },
+#endif
 #endif
 	{ PLATFORM_NONE, 0 }
 };
@@ -466,7 +468,9 @@ struct mVideoLogContext* mVideoLogContextCreate(struct mCore* core) {
 		context->initialStateSize = core->stateSize(core);
 		context->initialState = anonymousMemoryMap(context->initialStateSize);
 		core->saveState(core, context->initialState);
+#ifndef MINIMAL_CORE
 		core->startVideoLog(core, context);
+#endif
 	}
 
 	context->activeChannel = 0;
@@ -676,9 +680,11 @@ void mVideoLogContextDestroy(struct mCore* core, struct mVideoLogContext* contex
 		context->backing->write(context->backing, &header, sizeof(header));
 	}
 
+#ifndef MINIMAL_CORE
 	if (core) {
 		core->endVideoLog(core);
 	}
+#endif
 	if (context->initialState) {
 		mappedMemoryFree(context->initialState, context->initialStateSize);
 	}
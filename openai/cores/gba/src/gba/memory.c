@@ -1305,31 +1305,13 @@ void GBAPatch8(struct ARMCore* cpu, uint32_t address, int8_t value, int8_t* old)
 }
 
 #define LDM_LOOP(LDM) \
-	for (i = 0; i < 16; i += 4) { \
-		if (UNLIKELY(mask & (1 << i))) { \
-			LDM; \
-			cpu->gprs[i] = value; \
-			++wait; \
-			address += 4; \
-		} \
-		if (UNLIKELY(mask & (2 << i))) { \
-			LDM; \
-			cpu->gprs[i + 1] = value; \
-			++wait; \
-			address += 4; \
-		} \
-		if (UNLIKELY(mask & (4 << i))) { \
-			LDM; \
-			cpu->gprs[i + 2] = value; \
-			++wait; \
-			address += 4; \
-		} \
-		if (UNLIKELY(mask & (8 << i))) { \
-			LDM; \
-			cpu->gprs[i + 3] = value; \
-			++wait; \
-			address += 4; \
-		} \
+	while (mask) { \
+		i = ctz32(mask); \
+		LDM; \
+		cpu->gprs[i] = value; \
+		++wait; \
+		address += 4; \
+		mask &= mask - 1; \
 	}
 
 uint32_t GBALoadMultiple(struct ARMCore* cpu, uint32_t address, int mask, enum LSMDirection direction, int* cycleCounter) {
@@ -1417,34 +1399,16 @@ uint32_t GBALoadMultiple(struct ARMCore* cpu, uint32_t address, int mask, enum L
 }
 
 #define STM_LOOP(STM) \
-	for (i = 0; i < 16; i += 4) { \
-		if (UNLIKELY(mask & (1 << i))) { \
-			value = cpu->gprs[i]; \
-			STM; \
-			++wait; \
-			address += 4; \
-		} \
-		if (UNLIKELY(mask & (2 << i))) { \
-			value = cpu->gprs[i + 1]; \
-			STM; \
-			++wait; \
-			address += 4; \
-		} \
-		if (UNLIKELY(mask & (4 << i))) { \
-			value = cpu->gprs[i + 2]; \
-			STM; \
-			++wait; \
-			address += 4; \
-		} \
-		if (UNLIKELY(mask & (8 << i))) { \
-			value = cpu->gprs[i + 3]; \
-			if (i + 3 == ARM_PC) { \
-				value += WORD_SIZE_ARM; \
-			} \
-			STM; \
-			++wait; \
-			address += 4; \
+	while (mask) { \
+		i = ctz32(mask); \
+		value = cpu->gprs[i]; \
+		if (i == ARM_PC) { \
+			value += WORD_SIZE_ARM; \
 		} \
+		STM; \
+		++wait; \
+		address += 4; \
+		mask &= mask - 1; \
 	}
 
 uint32_t GBAStoreMultiple(struct ARMCore* cpu, uint32_t address, int mask, enum LSMDirection direction, int* cycleCounter) {
@@ -20,6 +20,8 @@
 #include <mgba/gba/core.h>
 #include <mgba/gba/interface.h>
 #include <mgba/internal/gba/gba.h>
+#include <mgba/internal/gba/renderers/proxy.h>
+#include <mgba/feature/deferred-proxy.h>
 #endif
 #include <mgba-util/circle-buffer.h>
 #include <mgba-util/memory.h>
@@ -37,6 +39,13 @@ FS_Archive sdmcArchive;
 #define SAMPLES 1024
 #define RUMBLE_PWM 35
 
+/* Gym Retro frontend extension, must match openai/src/emulator.h */
+#define RETRO_ENVIRONMENT_RETRO_SET_FRAME_COMPOSER (3 | RETRO_ENVIRONMENT_PRIVATE)
+
+struct retro_frame_composer {
+	void (*compose)(void);
+};
+
 static retro_environment_t environCallback;
 static retro_video_refresh_t videoCallback;
 static retro_audio_sample_batch_t audioCallback;
@@ -51,6 +60,10 @@ static void _postAudioBuffer(struct mAVStream*, blip_t* left, blip_t* right);
 static void _setRumble(struct mRumble* rumble, int enable);
 static uint8_t _readLux(struct GBALuminanceSource* lux);
 static void _updateLux(struct GBALuminanceSource* lux);
+#ifdef M_CORE_GBA
+static void _composeFrame(void);
+static void _setupDeferredVideo(struct mCore* core);
+#endif
 
 static struct mCore* core;
 static void* outputBuffer;
@@ -64,6 +77,11 @@ static struct mRumble rumble;
 static struct GBALuminanceSource lux;
 static int luxLevel;
 static struct mLogger logger;
+#ifdef M_CORE_GBA
+static struct GBAVideoProxyRenderer deferredRenderer;
+static struct mVideoDeferredProxy deferredProxy;
+static bool deferredVideo;
+#endif
 
 static void _reloadSettings(void) {
 	struct mCoreOptions opts = {
@@ -385,6 +403,12 @@ void retro_run(void) {
 		}
 	}
 
+#ifdef M_CORE_GBA
+	if (deferredVideo) {
+		// The last frame was never composed, so only catch the renderer up
+		mVideoDeferredProxyRun(&deferredProxy, false);
+	}
+#endif
 	core->runFrame(core);
 	unsigned width, height;
 	core->desiredVideoDimensions(core, &width, &height);
@@ -483,9 +507,27 @@ static void _setupMaps(struct mCore* core) {
 #endif
 }
 
+#ifdef M_CORE_GBA
+static void _composeFrame(void) {
+	mVideoDeferredProxyRun(&deferredProxy, true);
+}
+
+static void _setupDeferredVideo(struct mCore* core) {
+	if (!deferredVideo || core->platform(core) != PLATFORM_GBA) {
+		return;
+	}
+	// Resetting the core puts its own renderer back, so shim it again
+	struct GBA* gba = core->board;
+	GBAVideoProxyRendererShim(&gba->video, &deferredRenderer);
+}
+#endif
+
 void retro_reset(void) {
 	core->reset(core);
 	_setupMaps(core);
+#ifdef M_CORE_GBA
+	_setupDeferredVideo(core);
+#endif
 
 	if (rumbleCallback) {
 		CircleBufferClear(&rumbleHistory);
@@ -593,8 +635,25 @@ bool retro_load_game(const struct retro_game_info* game)
 		}
 	}
 
+#ifdef M_CORE_GBA
+	deferredVideo = false;
+	if (core->platform(core) == PLATFORM_GBA) {
+		// Only draw frames the frontend actually looks at, if it can tell us
+		struct retro_frame_composer composer = { _composeFrame };
+		deferredVideo = environCallback(RETRO_ENVIRONMENT_RETRO_SET_FRAME_COMPOSER, &composer);
+		if (deferredVideo) {
+			mVideoDeferredProxyCreate(&deferredProxy);
+			deferredRenderer.logger = &deferredProxy.d;
+			GBAVideoProxyRendererCreate(&deferredRenderer, NULL);
+		}
+	}
+#endif
+
 	core->reset(core);
 	_setupMaps(core);
+#ifdef M_CORE_GBA
+	_setupDeferredVideo(core);
+#endif
 
 	return true;
 }
@@ -604,6 +663,9 @@ void retro_unload_game(void) {
 		return;
 	}
 	core->deinit(core);
+#ifdef M_CORE_GBA
+	deferredVideo = false;
+#endif
 	mappedMemoryFree(data, dataSize);
 	data = 0;
 	mappedMemoryFree(savedata, SIZE_CART_FLASH1M);
@@ -627,6 +689,12 @@ bool retro_unserialize(const void* data, size_t size) {
 	if (size != retro_serialize_size()) {
 		return false;
 	}
+#ifdef M_CORE_GBA
+	if (deferredVideo) {
+		// Finish the pending frame so the screen matches what it was before
+		_composeFrame();
+	}
+#endif
 	core->loadState(core, data);
 	return true;
 }
@@ -72,6 +72,13 @@
  */
 #define M68K_CHECK_PC_ADDRESS_ERROR OPT_OFF
 
+/* If ON, the CPU will recognize loops polling memory without side effects
+ * (e.g. TST.W $FFxxxx / BEQ.S) when a timeslice starts and skip their
+ * remaining iterations within that timeslice, since nothing else can modify
+ * memory until it ends.
+ */
+#define M68K_SKIP_IDLE_LOOPS        OPT_ON
+
 
 /* ----------------------------- COMPATIBILITY ---------------------------- */
 
@@ -253,6 +253,129 @@ void m68k_set_irq_delay(unsigned int int_level)
   m68ki_check_interrupts(); /* Level triggered (IRQ) */
 }
 
+#if M68K_SKIP_IDLE_LOOPS
+/* Returns the length of a memory test instruction which only updates the CCR */
+/* (TST, CMPI or BTST #n with absolute addressing) or 0 if none is found.      */
+static uint m68ki_idle_test_length(uint pc)
+{
+  uint ir = m68k_read_immediate_16(pc);
+  uint length = 2;
+  uint size, address;
+  cpu_memory_map *temp;
+
+  switch (ir & 0xffc0)
+  {
+    case 0x4a00: size = 1; break;               /* TST.B */
+    case 0x4a40: size = 2; break;               /* TST.W */
+    case 0x4a80: size = 4; break;               /* TST.L */
+    case 0x0c00: size = 1; length += 2; break;  /* CMPI.B #imm */
+    case 0x0c40: size = 2; length += 2; break;  /* CMPI.W #imm */
+    case 0x0c80: size = 4; length += 4; break;  /* CMPI.L #imm */
+    case 0x0800: size = 1; length += 2; break;  /* BTST #n */
+    default: return 0;
+  }
+
+  switch (ir & 0x3f)
+  {
+    case 0x38:  /* (xxx).W */
+      address = MAKE_INT_16(m68k_read_immediate_16(pc + length));
+      length += 2;
+      break;
+    case 0x39:  /* (xxx).L */
+      address = m68k_read_immediate_32(pc + length);
+      length += 4;
+      break;
+    default:
+      return 0;
+  }
+
+  /* I/O handlers may have side effects or depend on cycle count */
+  temp = &m68ki_cpu.memory_map[(address >> 16) & 0xff];
+  if ((size == 1) ? (temp->read8 != NULL) : (temp->read16 != NULL))
+  {
+    return 0;
+  }
+
+  return length;
+}
+
+/* Returns TRUE if the instruction is a Bcc.B or BRA.B (not BSR) */
+#define m68ki_idle_short_branch(ir) ((((ir) & 0xf000) == 0x6000) && (((ir) & 0x0f00) != 0x0100) && ((ir) & 0xff) && (((ir) & 0xff) != 0xff))
+
+/* Executes a single instruction */
+static void m68ki_idle_step(void)
+{
+  REG_IR = m68ki_read_imm_16();
+  m68ki_instruction_jump_table[REG_IR]();
+  USE_CYCLES(CYC_INSTRUCTION[REG_IR]);
+}
+
+/* Idle loop detection: a memory test (or nothing) followed by a short branch */
+/* back to it. Once one iteration has been executed and returned to the loop  */
+/* start, next iterations only depend on memory that no other component can   */
+/* modify before the end of the timeslice, so they are skipped by only adding */
+/* their cycles, up to the point where the regular loop has to stop.          */
+static void m68ki_skip_idle_loop(uint cycles)
+{
+  uint pc = REG_PC;
+  uint ir = m68k_read_immediate_16(pc);
+  uint start, branch, c, test, loop;
+
+  if (m68ki_idle_short_branch(ir))
+  {
+    /* CPU is about to branch back to the loop start */
+    branch = pc;
+    start = pc + 2 + MAKE_INT_8(ir);
+  }
+  else
+  {
+    /* CPU is at the loop start */
+    start = pc;
+    branch = pc + m68ki_idle_test_length(pc);
+    ir = m68k_read_immediate_16(branch);
+    if ((branch == start) || !m68ki_idle_short_branch(ir) || ((branch + 2 + MAKE_INT_8(ir)) != start))
+    {
+      return;
+    }
+  }
+
+  /* loop body is empty or a single memory test */
+  if ((start != branch) && ((start + m68ki_idle_test_length(start)) != branch))
+  {
+    return;
+  }
+
+  /* finish current iteration */
+  if (pc != start)
+  {
+    if (m68k.cycles >= cycles) return;
+    m68ki_idle_step();
+    if (REG_PC != start) return;
+  }
+
+  /* execute one full iteration to make sure the branch is taken */
+  c = m68k.cycles;
+  if (start != branch)
+  {
+    if (m68k.cycles >= cycles) return;
+    m68ki_idle_step();
+    if (REG_PC != branch) return;
+  }
+  test = m68k.cycles - c;
+  if (m68k.cycles >= cycles) return;
+  m68ki_idle_step();
+  if (REG_PC != start) return;
+  loop = m68k.cycles - c;
+
+  /* skip all iterations the CPU would fully execute before the end of the timeslice */
+  c = m68k.cycles;
+  if ((c + test) < cycles)
+  {
+    m68k.cycles = c + (((cycles - 1 - c - test) / loop) + 1) * loop;
+  }
+}
+#endif
+
 void m68k_run(unsigned int cycles) 
 {
   /* Make sure CPU is not already ahead */
@@ -280,6 +403,11 @@ void m68k_run(unsigned int cycles)
 #ifdef LOGVDP
   error("[%d][%d] m68k run to %d cycles (%x), irq mask = %x (%x)\n", v_counter, m68k.cycles, cycles, m68k.pc,FLAG_INT_MASK, CPU_INT_LEVEL);
 #endif
+
+#if M68K_SKIP_IDLE_LOOPS
+  /* Skip polling loop iterations if CPU is waiting */
+  m68ki_skip_idle_loop(cycles);
+#endif
    
   while (m68k.cycles < cycles)
   {
@@ -676,6 +676,9 @@ void system_frame_gen(int do_skip)
     bitmap.viewport.changed |= 1;
   }
 
+  /* wait for last line to be rendered */
+  render_sync();
+
   /* adjust timings for next frame */
   input_end_frame(mcycles_vdp);
   m68k.cycles -= mcycles_vdp;
@@ -1019,6 +1022,9 @@ void system_frame_scd(int do_skip)
     bitmap.viewport.changed |= 1;
   }
   
+  /* wait for last line to be rendered */
+  render_sync();
+
   /* adjust timings for next frame */
   scd_end_frame(scd.cycles);
   input_end_frame(mcycles_vdp);
@@ -1425,6 +1431,9 @@ void system_frame_sms(int do_skip)
     bitmap.viewport.changed |= 1;
   }
 
+  /* wait for last line to be rendered */
+  render_sync();
+
   /* adjust timings for next frame */
   input_end_frame(mcycles_vdp);
   Z80.cycles -= mcycles_vdp;
@@ -243,6 +243,9 @@ void vdp_reset(void)
 {
   int i;
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   memset ((char *) sat, 0, sizeof (sat));
   memset ((char *) vram, 0, sizeof (vram));
   memset ((char *) cram, 0, sizeof (cram));
@@ -440,6 +443,9 @@ int vdp_context_save(uint8 *state)
 {
   int bufferptr = 0;
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   save_param(sat, sizeof(sat));
   save_param(vram, sizeof(vram));
   save_param(cram, sizeof(cram));
@@ -468,6 +474,9 @@ int vdp_context_load(uint8 *state)
   int i, bufferptr = 0;
   uint8 temp_reg[0x20];
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   load_param(sat, sizeof(sat));
   load_param(vram, sizeof(vram));
   load_param(cram, sizeof(cram));
@@ -575,6 +584,9 @@ void vdp_dma_update(unsigned int cycles)
 {
   unsigned int dma_cycles, dma_bytes;
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* DMA transfer rate (bytes per line) 
 
       DMA Mode      Width       Display      Transfer Count
@@ -691,6 +703,9 @@ void vdp_dma_update(unsigned int cycles)
 
 void vdp_68k_ctrl_w(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Check pending flag */
   if (pending == 0)
   {
@@ -839,6 +854,9 @@ void vdp_68k_ctrl_w(unsigned int data)
 /* Mega Drive VDP control port specific (MS compatibility mode) */
 void vdp_z80_ctrl_w(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   switch (pending)
   {
     case 0:
@@ -963,6 +981,9 @@ void vdp_z80_ctrl_w(unsigned int data)
 /* Master System & Game Gear VDP control port specific */
 void vdp_sms_ctrl_w(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   if (pending == 0)
   {
     /* Update address register LSB */
@@ -1086,6 +1107,9 @@ void vdp_sms_ctrl_w(unsigned int data)
 /* SG-1000 VDP (TMS99xx) control port specific */
 void vdp_tms_ctrl_w(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   if (pending == 0)
   {
     /* Latch LSB */
@@ -1151,6 +1175,9 @@ unsigned int vdp_68k_ctrl_r(unsigned int cycles)
 {
   unsigned int temp;
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Cycle-accurate VDP status read (68k read cycle takes four CPU cycles i.e 28 Mcycles) */
   cycles += 4 * 7;
 
@@ -1214,6 +1241,9 @@ unsigned int vdp_z80_ctrl_r(unsigned int cycles)
 {
   unsigned int temp;
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Check if DMA busy flag is set (Mega Drive VDP specific) */
   if (status & 2)
   {
@@ -2254,6 +2284,9 @@ static void vdp_bus_w(unsigned int data)
 
 static void vdp_68k_data_w_m4(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2346,6 +2379,9 @@ static void vdp_68k_data_w_m4(unsigned int data)
 
 static void vdp_68k_data_w_m5(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2405,6 +2441,9 @@ static unsigned int vdp_68k_data_r_m4(void)
   /* VRAM address (interleaved format) */
   int index = ((addr << 1) & 0x3FC) | ((addr & 0x200) >> 8) | (addr & 0x3C00);
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2419,6 +2458,9 @@ static unsigned int vdp_68k_data_r_m5(void)
 {
   uint16 data = 0;
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2515,6 +2557,9 @@ static unsigned int vdp_68k_data_r_m5(void)
 
 static void vdp_z80_data_w_m4(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2567,6 +2612,9 @@ static void vdp_z80_data_w_m4(unsigned int data)
 
 static void vdp_z80_data_w_m5(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2681,6 +2729,9 @@ static unsigned int vdp_z80_data_r_m4(void)
   /* Read buffer */
   unsigned int data = fifo[0];
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2698,6 +2749,9 @@ static unsigned int vdp_z80_data_r_m5(void)
 {
   unsigned int data = 0;
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2751,6 +2805,9 @@ static unsigned int vdp_z80_data_r_m5(void)
 
 static void vdp_z80_data_w_ms(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2827,6 +2884,9 @@ static void vdp_z80_data_w_ms(unsigned int data)
 
 static void vdp_z80_data_w_gg(unsigned int data)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2916,6 +2976,9 @@ static void vdp_z80_data_w_sg(unsigned int data)
   /* VRAM address */
   int index = addr & 0x3FFF;
 
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
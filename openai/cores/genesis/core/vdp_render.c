@@ -43,6 +43,12 @@
 #include "md_ntsc.h"
 #include "sms_ntsc.h"
 
+#ifdef USE_RENDER_THREAD
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
 /*** NTSC Filters ***/
 extern md_ntsc_t *md_ntsc;
 extern sms_ntsc_t *sms_ntsc;
@@ -417,7 +423,7 @@ INLINE void WRITE_LONG(void *address, uint32 data)
     { \
       temp |= (lb[i] << 8); \
       lb[i] = TABLE[temp | ATTR]; \
-      status |= ((temp & 0x8000) >> 10); \
+      obj_status |= ((temp & 0x8000) >> 10); \
     } \
   }
 
@@ -575,6 +581,9 @@ static uint8 linebuf[2][0x200];
 /* Sprite limit flag */
 static uint8 spr_ovr;
 
+/* Sprite collision flag (Mode 5), latched into VDP status once the line is drawn */
+static uint16 obj_status;
+
 /* Sprite parsing lists */
 typedef struct
 {
@@ -592,6 +601,29 @@ static uint8 object_count[2];
 /* Sprite Collision Info */
 uint16 spr_col;
 
+#ifdef USE_RENDER_THREAD
+/* Render thread: Mode 5 lines are drawn on a helper thread while the CPUs */
+/* run the next line. Any access to VDP state from the emulation thread     */
+/* waits for the pending line first (see render_sync), so output is the    */
+/* same as when lines are drawn synchronously.                              */
+#define RENDER_JOB_NONE   0
+#define RENDER_JOB_LINE   1
+#define RENDER_JOB_EXIT   2
+
+/* Busy-wait iterations before yielding the CPU, and before the render thread goes to sleep */
+#define RENDER_PAUSE_COUNT 0x100
+#define RENDER_SPIN_COUNT  0x10000
+
+int render_pending;
+static int render_thread_running;
+static pthread_t render_thread;
+static pthread_mutex_t render_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t render_cond = PTHREAD_COND_INITIALIZER;
+static int render_job;
+static int render_job_line;
+static int render_sleeping;
+#endif
+
 /* Function pointers */
 void (*render_bg)(int line);
 void (*render_obj)(int line);
@@ -4071,6 +4103,9 @@ void render_init(void)
 
 void render_reset(void)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   /* Clear display bitmap */
   memset(bitmap.data, 0, bitmap.pitch * bitmap.height);
 
@@ -4085,6 +4120,7 @@ void render_reset(void)
 
   /* Reset Sprite infos */
   spr_ovr = spr_col = object_count[0] = object_count[1] = 0;
+  obj_status = 0;
 }
 
 
@@ -4092,44 +4128,184 @@ void render_reset(void)
 /* Line rendering functions                                                 */
 /*--------------------------------------------------------------------------*/
 
-void render_line(int line)
+static void draw_line(int line)
 {
-  /* Check display status */
-  if (reg[1] & 0x40)
+  /* Update pattern cache */
+  if (bg_list_index)
+  {
+    update_bg_pattern_cache(bg_list_index);
+    bg_list_index = 0;
+  }
+
+  /* Render BG layer(s) */
+  render_bg(line);
+
+  /* Render sprite layer */
+  render_obj(line & 1);
+
+  /* Left-most column blanking */
+  if (reg[0] & 0x20)
   {
-    /* Update pattern cache */
-    if (bg_list_index)
+    if (system_hw > SYSTEM_SGII)
     {
-      update_bg_pattern_cache(bg_list_index);
-      bg_list_index = 0;
+      memset(&linebuf[0][0x20], 0x40, 8);
     }
+  }
 
-    /* Render BG layer(s) */
-    render_bg(line);
+  /* Horizontal borders */
+  if (bitmap.viewport.x > 0)
+  {
+    memset(&linebuf[0][0x20 - bitmap.viewport.x], 0x40, bitmap.viewport.x);
+    memset(&linebuf[0][0x20 + bitmap.viewport.w], 0x40, bitmap.viewport.x);
+  }
+}
 
-    /* Render sprite layer */
-    render_obj(line & 1);
+#ifdef USE_RENDER_THREAD
+INLINE void render_pause(int spins)
+{
+  if (spins < RENDER_PAUSE_COUNT)
+  {
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+  }
+  else
+  {
+    sched_yield();
+  }
+}
+
+static void *render_thread_main(void *arg)
+{
+  int spins = 0;
+  int job;
 
-    /* Left-most column blanking */
-    if (reg[0] & 0x20)
+  while ((job = __atomic_load_n(&render_job, __ATOMIC_ACQUIRE)) != RENDER_JOB_EXIT)
+  {
+    if (job == RENDER_JOB_LINE)
+    {
+      draw_line(render_job_line);
+      remap_line(render_job_line);
+      __atomic_store_n(&render_job, RENDER_JOB_NONE, __ATOMIC_RELEASE);
+      spins = 0;
+    }
+    else if (++spins < RENDER_SPIN_COUNT)
     {
-      if (system_hw > SYSTEM_SGII)
+      render_pause(spins);
+    }
+    else
+    {
+      /* Idle for a while (between frames), wait for the next line */
+      pthread_mutex_lock(&render_mutex);
+      __atomic_store_n(&render_sleeping, 1, __ATOMIC_SEQ_CST);
+      while (__atomic_load_n(&render_job, __ATOMIC_SEQ_CST) == RENDER_JOB_NONE)
       {
-        memset(&linebuf[0][0x20], 0x40, 8);
+        pthread_cond_wait(&render_cond, &render_mutex);
       }
+      __atomic_store_n(&render_sleeping, 0, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&render_mutex);
+      spins = 0;
     }
+  }
 
-    /* Parse sprites for next line */
-    if (line < (bitmap.viewport.h - 1))
+  return NULL;
+}
+
+static void render_dispatch(int job)
+{
+  __atomic_store_n(&render_job, job, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&render_sleeping, __ATOMIC_SEQ_CST) || (job == RENDER_JOB_EXIT))
+  {
+    pthread_mutex_lock(&render_mutex);
+    pthread_cond_signal(&render_cond);
+    pthread_mutex_unlock(&render_mutex);
+  }
+}
+
+int render_thread_start(void)
+{
+  if (!render_thread_running)
+  {
+    /* Drawing lines in parallel only pays off with a spare CPU */
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
     {
-      parse_satb(line);
+      return 0;
     }
 
-    /* Horizontal borders */
-    if (bitmap.viewport.x > 0)
+    render_job = RENDER_JOB_NONE;
+    if (pthread_create(&render_thread, NULL, render_thread_main, NULL))
     {
-      memset(&linebuf[0][0x20 - bitmap.viewport.x], 0x40, bitmap.viewport.x);
-      memset(&linebuf[0][0x20 + bitmap.viewport.w], 0x40, bitmap.viewport.x);
+      return 0;
+    }
+    render_thread_running = 1;
+  }
+
+  return 1;
+}
+
+void render_thread_stop(void)
+{
+  if (render_thread_running)
+  {
+    render_sync();
+    render_dispatch(RENDER_JOB_EXIT);
+    pthread_join(render_thread, NULL);
+    render_thread_running = 0;
+    render_job = RENDER_JOB_NONE;
+  }
+}
+
+void render_wait(void)
+{
+  int spins = 0;
+
+  while (__atomic_load_n(&render_job, __ATOMIC_ACQUIRE) != RENDER_JOB_NONE)
+  {
+    render_pause(spins++);
+  }
+  render_pending = 0;
+
+  /* Latch SCOL flag */
+  status |= obj_status;
+  obj_status = 0;
+}
+#endif
+
+void render_line(int line)
+{
+  /* Wait for pending line rendering */
+  render_sync();
+
+  /* Check display status */
+  if (reg[1] & 0x40)
+  {
+#ifdef USE_RENDER_THREAD
+    /* Mode 5 lines are drawn on the render thread */
+    if (render_thread_running && (system_hw & SYSTEM_MD) && (reg[1] & 0x04))
+    {
+      /* Sprites are parsed right away, as they may set SOVR flag */
+      if (line < (bitmap.viewport.h - 1))
+      {
+        parse_satb(line);
+      }
+
+      render_job_line = line;
+      render_pending = 1;
+      render_dispatch(RENDER_JOB_LINE);
+      return;
+    }
+#endif
+
+    draw_line(line);
+
+    /* Latch SCOL flag */
+    status |= obj_status;
+    obj_status = 0;
+
+    /* Parse sprites for next line */
+    if (line < (bitmap.viewport.h - 1))
+    {
+      parse_satb(line);
     }
   }
   else
@@ -4155,6 +4331,9 @@ void render_line(int line)
 
 void blank_line(int line, int offset, int width)
 {
+  /* Wait for pending line rendering */
+  render_sync();
+
   memset(&linebuf[0][0x20 + offset], 0x40, width);
   remap_line(line);
 }
@@ -100,6 +100,16 @@
 
 /* Global variables */
 extern uint16 spr_col;
+#ifdef USE_RENDER_THREAD
+extern int render_pending;
+#endif
+
+/* Wait for the line being drawn on the render thread (if any) before touching VDP state */
+#ifdef USE_RENDER_THREAD
+#define render_sync() do { if (render_pending) render_wait(); } while (0)
+#else
+#define render_sync()
+#endif
 
 /* Function prototypes */
 extern void render_init(void);
@@ -107,6 +117,11 @@ extern void render_reset(void);
 extern void render_line(int line);
 extern void blank_line(int line, int offset, int width);
 extern void remap_line(int line);
+#ifdef USE_RENDER_THREAD
+extern int render_thread_start(void);
+extern void render_thread_stop(void);
+extern void render_wait(void);
+#endif
 extern void window_clip(unsigned int data, unsigned int sw);
 extern void render_bg_m0(int line);
 extern void render_bg_m1(int line);
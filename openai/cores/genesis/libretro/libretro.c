@@ -100,6 +100,12 @@ static int vwidth;
 static int vheight;
 static double vaspect_ratio;
 
+/* Gym Retro frontend extension, must match openai/src/emulator.h */
+#define RETRO_ENVIRONMENT_RETRO_GET_FIXED_GEOMETRY (4 | RETRO_ENVIRONMENT_PRIVATE)
+
+/* Frame size and core options are settled once at load (headless frontends) */
+static bool fixed_geometry = false;
+
 static uint32_t brm_crc[2];
 static uint8_t brm_format[0x40] =
 {
@@ -794,6 +800,28 @@ static bool update_viewport(void)
    return ((ow != vwidth) || (oh != vheight) || (oar != vaspect_ratio));
 }
 
+static void set_fixed_geometry(void)
+{
+  /* Widest line of the usual display modes on this system (H40 on Mega Drive), */
+  /* so that video mode switches keep the frame size                            */
+  int md = (system_hw & SYSTEM_MD) && (system_hw != SYSTEM_PBC);
+  int width = md ? 320 : 256;
+  int height = md ? 224 : 192;
+
+  /* Neither the NTSC filter nor double field output fit a fixed frame */
+  config.ntsc = 0;
+  config.render = 0;
+
+  vwidth = width + (bitmap.viewport.x * 2);
+  vheight = height + (bitmap.viewport.y * 2);
+  vaspect_ratio = calculate_display_aspect_ratio();
+
+  /* Pack lines tightly, so that a frame is one contiguous block */
+  bitmap.width = vwidth;
+  bitmap.pitch = vwidth * 2;
+  memset(bitmap.data, 0, bitmap.pitch * bitmap.height);
+}
+
 static void check_variables(void)
 {
   unsigned orig_value;
@@ -1209,6 +1237,18 @@ static void check_variables(void)
       config.invert_mouse = 1;
   }
 
+#ifdef USE_RENDER_THREAD
+  var.key = "genesis_plus_gx_render_thread";
+  var.value = NULL;
+  environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var);
+  {
+    if (var.value && strcmp(var.value, "enabled") == 0)
+      render_thread_start();
+    else
+      render_thread_stop();
+  }
+#endif
+
   if (reinit)
   {
     audio_init(SOUND_FREQUENCY, 0);
@@ -1645,6 +1685,9 @@ void retro_set_environment(retro_environment_t cb)
       { "genesis_plus_gx_render", "Interlaced mode 2 output; single field|double field" },
       { "genesis_plus_gx_gun_cursor", "Show Lightgun crosshair; disabled|enabled" },
       { "genesis_plus_gx_invert_mouse", "Invert Mouse Y-axis; disabled|enabled" },
+#ifdef USE_RENDER_THREAD
+      { "genesis_plus_gx_render_thread", "Render on a separate thread; disabled|enabled" },
+#endif
       { NULL, NULL },
    };
 
@@ -2162,6 +2205,18 @@ bool retro_load_game(const struct retro_game_info *info)
 
    update_viewport();
 
+   fixed_geometry = false;
+   if (environ_cb(RETRO_ENVIRONMENT_RETRO_GET_FIXED_GEOMETRY, &fixed_geometry) && fixed_geometry)
+   {
+      set_fixed_geometry();
+   }
+   else
+   {
+      fixed_geometry = false;
+      bitmap.width = 720;
+      bitmap.pitch = 720 * 2;
+   }
+
    return true;
 }
 
@@ -2263,6 +2318,9 @@ void retro_init(void)
 
 void retro_deinit(void)
 {
+#ifdef USE_RENDER_THREAD
+   render_thread_stop();
+#endif
 }
 
 void retro_reset(void)
@@ -2282,7 +2340,7 @@ void retro_run(void)
    else
       system_frame_sms(0);
 
-   if (bitmap.viewport.changed & 9)
+   if ((bitmap.viewport.changed & 9) && !fixed_geometry)
    {
       bool geometry_updated = update_viewport();
       bitmap.viewport.changed &= ~1;
@@ -2322,9 +2380,12 @@ void retro_run(void)
       }
    }
 
-   video_cb(bitmap.data, vwidth, vheight, 720 * 2);
+   video_cb(bitmap.data, vwidth, vheight, bitmap.pitch);
    audio_cb(soundbuffer, audio_update(soundbuffer));
 
+   if (fixed_geometry)
+      return;
+
    environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated);
    if (updated)
    {
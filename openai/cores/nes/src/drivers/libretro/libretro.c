@@ -67,8 +67,23 @@ static __attribute__((aligned(16))) uint16_t retro_palette[256];
 #else
 static uint16_t retro_palette[256];
 #endif
+static uint8_t retro_palette_rgb[256 * 3];
 static uint16_t* fceu_video_out;
 
+/* Gym Retro frontend extension, must match openai/src/emulator.h */
+#define RETRO_ENVIRONMENT_RETRO_SET_INDEXED_FRAME (1 | RETRO_ENVIRONMENT_PRIVATE)
+#define RETRO_ENVIRONMENT_RETRO_GET_INDEXED_ONLY (2 | RETRO_ENVIRONMENT_PRIVATE)
+#define RETRO_ENVIRONMENT_RETRO_SET_AUDIO_MONO (5 | RETRO_ENVIRONMENT_PRIVATE)
+
+struct retro_indexed_frame
+{
+   const uint8_t *data;
+   unsigned width;
+   unsigned height;
+   size_t pitch;
+   const uint8_t *palette;
+};
+
 
 /* Some timing-related variables. */
 static int soundo = 1;
@@ -76,6 +91,10 @@ static int soundo = 1;
 static volatile int nofocus = 0;
 
 static int32_t *sound = 0;
+/* The NES has a single audio channel; with a frontend that takes mono audio
+ * the samples are only narrowed to 16 bits instead of packed into pairs */
+static bool audio_mono = false;
+static int16_t sound_mono[2048 + 512];
 static uint32_t JSReturn[2];
 static uint32_t current_palette = 0;
 
@@ -133,6 +152,9 @@ int FCEUD_SendData(void *data, uint32 len)
 
 void FCEUD_SetPalette(unsigned char index, unsigned char r, unsigned char g, unsigned char b)
 {
+   retro_palette_rgb[index * 3 + 0] = r;
+   retro_palette_rgb[index * 3 + 1] = g;
+   retro_palette_rgb[index * 3 + 2] = b;
 #ifdef FRONTEND_SUPPORTS_RGB565
    retro_palette[index] = BUILD_PIXEL_RGB565(r >> RED_EXPAND, g >> GREEN_EXPAND, b >> BLUE_EXPAND);
 #else
@@ -1207,6 +1229,24 @@ void FCEUD_Update(uint8 *XBuf, int32 *Buffer, int Count)
 {
 }
 
+/* Hands the indexed frame to the frontend, returns true if the frontend
+ * doesn't need it expanded to RGB */
+static bool retro_run_indexed(uint8_t *gfx, unsigned width, unsigned height)
+{
+   struct retro_indexed_frame frame;
+   bool indexed_only = false;
+
+   frame.data    = gfx;
+   frame.width   = width;
+   frame.height  = height;
+   frame.pitch   = 256;
+   frame.palette = retro_palette_rgb;
+
+   if (!environ_cb(RETRO_ENVIRONMENT_RETRO_SET_INDEXED_FRAME, &frame))
+      return false;
+   return environ_cb(RETRO_ENVIRONMENT_RETRO_GET_INDEXED_ONLY, &indexed_only) && indexed_only;
+}
+
 static void retro_run_blit(uint8_t *gfx)
 {
    unsigned x, y;
@@ -1262,6 +1302,12 @@ static void retro_run_blit(uint8_t *gfx)
 
    video_cb(texture_vram_p, width, height, 256);
 #else
+   if (retro_run_indexed(gfx, width, height))
+   {
+      video_cb(NULL, width, height, pitch);
+      return;
+   }
+
    fb.width           = width;
    fb.height          = height;
    fb.access_flags    = RETRO_MEMORY_ACCESS_WRITE;
@@ -1307,10 +1353,20 @@ void retro_run(void)
    FCEUD_UpdateInput();
    FCEUI_Emulate(&gfx, &sound, &ssize, 0);
 
-   for (i = 0; i < ssize; i++)
-      sound[i] = (sound[i] << 16) | (sound[i] & 0xffff);
+   if (audio_mono)
+   {
+      for (i = 0; i < ssize; i++)
+         sound_mono[i] = (int16_t)sound[i];
+
+      audio_batch_cb(sound_mono, ssize);
+   }
+   else
+   {
+      for (i = 0; i < ssize; i++)
+         sound[i] = (sound[i] << 16) | (sound[i] & 0xffff);
 
-   audio_batch_cb((const int16_t*)sound, ssize);
+      audio_batch_cb((const int16_t*)sound, ssize);
+   }
 
    retro_run_blit(gfx);
 }
@@ -1787,6 +1843,10 @@ bool retro_load_game(const struct retro_game_info *game)
    mmaps.descriptors = descs;
    mmaps.num_descriptors = i;
    environ_cb(RETRO_ENVIRONMENT_SET_MEMORY_MAPS, &mmaps);
+
+   audio_mono = true;
+   if (!environ_cb(RETRO_ENVIRONMENT_RETRO_SET_AUDIO_MONO, &audio_mono))
+      audio_mono = false;
  
    return true;
 }
@@ -278,6 +278,8 @@ static void S9xSoftResetCPU (void)
 
 void S9xReset (void)
 {
+	RENDER_SYNC();
+
 	S9xResetSaveTimer(FALSE);
 	S9xResetLogger();
 
@@ -318,6 +320,8 @@ void S9xReset (void)
 
 void S9xSoftReset (void)
 {
+	RENDER_SYNC();
+
 	S9xResetSaveTimer(FALSE);
 
 	memset(Memory.FillRAM, 0, 0x8000);
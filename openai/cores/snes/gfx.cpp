@@ -194,6 +194,12 @@
 #include "font.h"
 #include "display.h"
 
+#ifdef USE_RENDER_THREAD
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
 extern struct SCheatData		Cheat;
 extern struct SLineData			LineData[240];
 extern struct SLineMatrixData	LineMatrixData[240];
@@ -215,6 +221,29 @@ static inline void DrawBackgroundMode7 (int, void (*DrawMath) (uint32, uint32, i
 static inline void DrawBackdrop (void);
 static inline void RenderScreen (bool8);
 static uint16 get_crosshair_color (uint8);
+static void PrepareLines (void);
+static void DrawLines (void);
+
+#ifdef USE_RENDER_THREAD
+// Render thread: once a line's scroll registers are latched, RenderLine() hands
+// the lines drawn so far to a helper thread, and the CPU goes on with the next
+// line. Every PPU register access, DMA, reset and snapshot waits for the helper
+// first (RENDER_SYNC), so it never sees PPU state change under it.
+#define RENDER_JOB_NONE		0
+#define RENDER_JOB_LINES	1
+#define RENDER_JOB_EXIT		2
+
+// busy-wait iterations before yielding the CPU, and before the render thread goes to sleep
+#define RENDER_PAUSE_COUNT	0x100
+#define RENDER_SPIN_COUNT	0x10000
+
+static bool8			RenderThreadRunning = FALSE;
+static pthread_t		RenderThread;
+static pthread_mutex_t	RenderMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	RenderCond = PTHREAD_COND_INITIALIZER;
+static int				RenderJob = RENDER_JOB_NONE;
+static int				RenderSleeping = 0;
+#endif
 
 #define TILE_PLUS(t, x)	(((t) & 0xfc00) | ((t + x) & 0x3ff))
 
@@ -334,6 +363,8 @@ void S9xBuildDirectColourMaps (void)
 
 void S9xStartScreenRefresh (void)
 {
+	RENDER_SYNC();
+
 	if (IPPU.RenderThisFrame)
 	{
 		GFX.InterlaceFrame = !GFX.InterlaceFrame;
@@ -392,6 +423,7 @@ void S9xStartScreenRefresh (void)
 		PPU.MosaicStart = 0;
 		PPU.RecomputeClipWindows = TRUE;
 		IPPU.PreviousLine = IPPU.CurrentLine = 0;
+		GFX.DrawnLine = 0;
 
 		memset(GFX.ZBuffer, 0, GFX.ScreenSize);
 		memset(GFX.SubZBuffer, 0, GFX.ScreenSize);
@@ -415,6 +447,7 @@ void S9xEndScreenRefresh (void)
 	if (IPPU.RenderThisFrame)
 	{
 		FLUSH_REDRAW();
+		RENDER_SYNC();
 
 		if (GFX.DoInterlace && GFX.InterlaceFrame == 0)
 		{
@@ -479,6 +512,103 @@ void S9xEndScreenRefresh (void)
 	}
 }
 
+#ifdef USE_RENDER_THREAD
+static inline void RenderPause (int spins)
+{
+	if (spins < RENDER_PAUSE_COUNT)
+	{
+	#if defined(__i386__) || defined(__x86_64__)
+		__builtin_ia32_pause();
+	#endif
+	}
+	else
+		sched_yield();
+}
+
+static void * RenderThreadMain (void *arg)
+{
+	int	spins = 0;
+	int	job;
+
+	while ((job = __atomic_load_n(&RenderJob, __ATOMIC_ACQUIRE)) != RENDER_JOB_EXIT)
+	{
+		if (job == RENDER_JOB_LINES)
+		{
+			DrawLines();
+			__atomic_store_n(&RenderJob, RENDER_JOB_NONE, __ATOMIC_RELEASE);
+			spins = 0;
+		}
+		else
+		if (++spins < RENDER_SPIN_COUNT)
+			RenderPause(spins);
+		else
+		{
+			// idle for a while (between frames), wait for the next lines
+			pthread_mutex_lock(&RenderMutex);
+			__atomic_store_n(&RenderSleeping, 1, __ATOMIC_SEQ_CST);
+			while (__atomic_load_n(&RenderJob, __ATOMIC_SEQ_CST) == RENDER_JOB_NONE)
+				pthread_cond_wait(&RenderCond, &RenderMutex);
+			__atomic_store_n(&RenderSleeping, 0, __ATOMIC_SEQ_CST);
+			pthread_mutex_unlock(&RenderMutex);
+			spins = 0;
+		}
+	}
+
+	return (NULL);
+}
+
+static void RenderDispatch (int job)
+{
+	__atomic_store_n(&RenderJob, job, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&RenderSleeping, __ATOMIC_SEQ_CST) || job == RENDER_JOB_EXIT)
+	{
+		pthread_mutex_lock(&RenderMutex);
+		pthread_cond_signal(&RenderCond);
+		pthread_mutex_unlock(&RenderMutex);
+	}
+}
+
+bool8 S9xRenderThreadStart (void)
+{
+	if (!RenderThreadRunning)
+	{
+		// drawing lines in parallel only pays off with a spare CPU
+		if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+			return (FALSE);
+
+		RenderJob = RENDER_JOB_NONE;
+		if (pthread_create(&RenderThread, NULL, RenderThreadMain, NULL))
+			return (FALSE);
+
+		RenderThreadRunning = TRUE;
+	}
+
+	return (TRUE);
+}
+
+void S9xRenderThreadStop (void)
+{
+	if (RenderThreadRunning)
+	{
+		RENDER_SYNC();
+		RenderDispatch(RENDER_JOB_EXIT);
+		pthread_join(RenderThread, NULL);
+		RenderThreadRunning = FALSE;
+		RenderJob = RENDER_JOB_NONE;
+	}
+}
+
+void S9xRenderWait (void)
+{
+	int	spins = 0;
+
+	while (__atomic_load_n(&RenderJob, __ATOMIC_ACQUIRE) != RENDER_JOB_NONE)
+		RenderPause(spins++);
+
+	GFX.RenderPending = FALSE;
+}
+#endif
+
 void RenderLine (uint8 C)
 {
 	if (IPPU.RenderThisFrame)
@@ -509,6 +639,25 @@ void RenderLine (uint8 C)
 		}
 
 		IPPU.CurrentLine = C + 1;
+
+	#ifdef USE_RENDER_THREAD
+		if (RenderThreadRunning)
+		{
+			// if the helper is still busy, these lines go with the next ones
+			if (GFX.RenderPending && __atomic_load_n(&RenderJob, __ATOMIC_ACQUIRE) == RENDER_JOB_NONE)
+				GFX.RenderPending = FALSE;
+
+			if (!GFX.RenderPending)
+			{
+				if (IPPU.OBJChanged || IPPU.InterlaceOBJ)
+					SetupOBJ();
+
+				PrepareLines();
+				GFX.RenderPending = TRUE;
+				RenderDispatch(RENDER_JOB_LINES);
+			}
+		}
+	#endif
 	}
 	else
 	{
@@ -650,16 +799,35 @@ static inline void RenderScreen (bool8 sub)
 
 void S9xUpdateScreen (void)
 {
+	RENDER_SYNC();
+
 	if (IPPU.OBJChanged || IPPU.InterlaceOBJ)
 		SetupOBJ();
 
 	// XXX: Check ForceBlank? Or anything else?
-	PPU.RangeTimeOver |= GFX.OBJLines[GFX.EndY].RTOFlags;
+	PPU.RangeTimeOver |= GFX.OBJLines[GFX.UpdateEndY].RTOFlags;
+
+	if ((GFX.UpdateEndY = IPPU.CurrentLine - 1) >= PPU.ScreenHeight)
+		GFX.UpdateEndY = PPU.ScreenHeight - 1;
+
+	// the render thread may have drawn these lines already
+	if (GFX.DrawnLine != IPPU.CurrentLine)
+	{
+		PrepareLines();
+		DrawLines();
+	}
+
+	IPPU.PreviousLine = IPPU.CurrentLine;
+}
 
-	GFX.StartY = IPPU.PreviousLine;
+static void PrepareLines (void)
+{
+	GFX.StartY = GFX.DrawnLine;
 	if ((GFX.EndY = IPPU.CurrentLine - 1) >= PPU.ScreenHeight)
 		GFX.EndY = PPU.ScreenHeight - 1;
 
+	GFX.DrawnLine = IPPU.CurrentLine;
+
 	if (!PPU.ForcedBlanking)
 	{
 		// If force blank, may as well completely skip all this. We only did
@@ -726,7 +894,13 @@ void S9xUpdateScreen (void)
 
 		if ((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2131] & 0x3f))
 			GFX.FixedColour = BUILD_PIXEL(IPPU.XB[PPU.FixedColourRed], IPPU.XB[PPU.FixedColourGreen], IPPU.XB[PPU.FixedColourBlue]);
+	}
+}
 
+static void DrawLines (void)
+{
+	if (!PPU.ForcedBlanking)
+	{
 		if (PPU.BGMode == 5 || PPU.BGMode == 6 || IPPU.PseudoHires ||
 			((Memory.FillRAM[0x2130] & 0x30) != 0x30 && (Memory.FillRAM[0x2130] & 2) && (Memory.FillRAM[0x2131] & 0x3f) && (Memory.FillRAM[0x212d] & 0x1f)))
 			// If hires (Mode 5/6 or pseudo-hires) or math is to be done
@@ -747,8 +921,6 @@ void S9xUpdateScreen (void)
 			for (int x = 0; x < IPPU.RenderedScreenWidth; x++)
 				GFX.S[x] = black;
 	}
-
-	IPPU.PreviousLine = IPPU.CurrentLine;
 }
 
 static void SetupOBJ (void)
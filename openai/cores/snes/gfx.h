@@ -212,6 +212,8 @@ struct SGFX
 	uint8	InterlaceFrame;
 	uint32	StartY;
 	uint32	EndY;
+	uint32	UpdateEndY;			// EndY of the last S9xUpdateScreen(), for the range/time over flags
+	int		DrawnLine;			// lines before this one are drawn (or being drawn)
 	bool8	ClipColors;
 	uint8	OBJWidths[128];
 	uint8	OBJVisibleTiles[128];
@@ -253,6 +255,10 @@ struct SGFX
 	const char	*InfoString;
 	uint32	InfoStringTimeout;
 	char	FrameDisplayString[256];
+
+#ifdef USE_RENDER_THREAD
+	bool8	RenderPending;		// lines are being drawn on the render thread
+#endif
 };
 
 struct SBG
@@ -353,6 +359,11 @@ void S9xUpdateScreen (void);
 void S9xBuildDirectColourMaps (void);
 void RenderLine (uint8);
 void S9xComputeClipWindows (void);
+#ifdef USE_RENDER_THREAD
+bool8 S9xRenderThreadStart (void);
+void S9xRenderThreadStop (void);
+void S9xRenderWait (void);
+#endif
 void S9xDisplayChar (uint16 *, uint8);
 // called automatically unless Settings.AutoDisplayMessages is false
 void S9xDisplayMessages (uint16 *, int, int, int, int);
@@ -370,6 +381,13 @@ void S9xReRefresh (void);
 void S9xSetPalette (void);
 void S9xSyncSpeed (void);
 
+// wait for the lines being drawn on the render thread (if any) before touching PPU state
+#ifdef USE_RENDER_THREAD
+#define RENDER_SYNC()	do { if (GFX.RenderPending) S9xRenderWait(); } while (0)
+#else
+#define RENDER_SYNC()
+#endif
+
 // called instead of S9xDisplayString if set to non-NULL
 extern void (*S9xCustomDisplayString) (const char *, int, int, bool);
 
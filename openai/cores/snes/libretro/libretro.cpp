@@ -141,6 +141,9 @@ void retro_set_environment(retro_environment_t cb)
       { "snes9x_sndchan_8", "Enable sound channel 8; enabled|disabled" },
       { "snes9x_overscan", "Crop overscan; auto|enabled|disabled" },
       { "snes9x_aspect", "Preferred aspect ratio; auto|ntsc|pal|4:3" },
+#ifdef USE_RENDER_THREAD
+      { "snes9x_render_thread", "Render on a separate thread; disabled|enabled" },
+#endif
       { NULL, NULL },
    };
 
@@ -232,6 +235,15 @@ static void update_variables(void)
    var.value=NULL;
    Settings.SupportHiRes=!(environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && !strcmp("disabled", var.value));
 
+#ifdef USE_RENDER_THREAD
+   var.key="snes9x_render_thread";
+   var.value=NULL;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp("enabled", var.value))
+      S9xRenderThreadStart();
+   else
+      S9xRenderThreadStop();
+#endif
+
    var.key = "snes9x_overscan";
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -982,6 +994,9 @@ void retro_run()
 
 void retro_deinit()
 {
+#ifdef USE_RENDER_THREAD
+   S9xRenderThreadStop();
+#endif
    S9xDeinitAPU();
    Memory.Deinit();
    S9xGraphicsDeinit();
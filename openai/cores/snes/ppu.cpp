@@ -349,6 +349,9 @@ void S9xSetPPU (uint8 Byte, uint16 Address)
 	else
 	if (Address <= 0x2183)
 	{
+		if (Address < 0x2180)
+			RENDER_SYNC();
+
 		switch (Address)
 		{
 			case 0x2100: // INIDISP
@@ -1131,6 +1134,9 @@ uint8 S9xGetPPU (uint16 Address)
     {
 		uint8	byte;
 
+		if (Address < 0x2180)
+			RENDER_SYNC();
+
 		switch (Address)
 		{
 			case 0x2104: // OAMDATA
@@ -1965,6 +1971,7 @@ void S9xSoftResetPPU (void)
 	IPPU.DoubleHeightPixels = FALSE;
 	IPPU.CurrentLine = 0;
 	IPPU.PreviousLine = 0;
+	GFX.DrawnLine = 0;
 	IPPU.XB = NULL;
 	for (int c = 0; c < 256; c++)
 		IPPU.ScreenColors[c] = c;
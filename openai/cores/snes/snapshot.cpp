@@ -1176,6 +1176,8 @@ static int UnfreezeStruct (STREAM, const char *, void *, FreezeData *, int, int)
 static int UnfreezeStructCopy (STREAM, const char *, uint8 **, FreezeData *, int, int);
 static void UnfreezeStructFromCopy (void *, FreezeData *, int, uint8 *, int);
 static void FreezeBlock (STREAM, const char *, uint8 *, int);
+static uint8 * FreezeBlockBegin (STREAM, const char *, int);
+static void FreezeBlockEnd (STREAM, uint8 *, int);
 static void FreezeStruct (STREAM, const char *, void *, FreezeData *, int);
 
 
@@ -1197,11 +1199,49 @@ void S9xResetSaveTimer (bool8 dontsave)
 	t = time(NULL);
 }
 
+// Everything that decides which blocks a snapshot holds. The block sizes
+// themselves are fixed, so the size only has to be measured once per layout.
+struct SFreezeLayout
+{
+	size_t	name_len;
+	bool8	blocks[10];
+	uint32	seta;
+};
+
+static void GetFreezeLayout (struct SFreezeLayout *layout)
+{
+	memset(layout, 0, sizeof(*layout));
+	layout->name_len = strlen(Memory.ROMFilename);
+	layout->blocks[0] = Settings.SuperFX;
+	layout->blocks[1] = Settings.SA1;
+	layout->blocks[2] = Settings.DSP;
+	layout->blocks[3] = Settings.C4;
+	layout->blocks[4] = Settings.OBC1;
+	layout->blocks[5] = Settings.SPC7110;
+	layout->blocks[6] = Settings.SRTC;
+	layout->blocks[7] = Settings.SPC7110RTC;
+	layout->blocks[8] = Settings.BS;
+	layout->blocks[9] = Settings.MSU1;
+	layout->seta = Settings.SETA;
+}
+
 uint32 S9xFreezeSize()
 {
-    nulStream stream;
-    S9xFreezeToStream(&stream);
-    return stream.size();
+	static struct SFreezeLayout	cached_layout;
+	static uint32				cached_size = 0;
+
+	struct SFreezeLayout	layout;
+	GetFreezeLayout(&layout);
+
+	if (!cached_size || memcmp(&layout, &cached_layout, sizeof(layout)) != 0)
+	{
+		nulStream stream;
+		S9xFreezeToStream(&stream);
+		cached_size = stream.size();
+		cached_layout = layout;
+	}
+
+	return (cached_size);
 }
 
 bool8 S9xFreezeGameMem (uint8 *buf, uint32 bufSize)
@@ -1304,7 +1344,9 @@ bool8 S9xUnfreezeGame (const char *filename)
 void S9xFreezeToStream (STREAM stream)
 {
 	char	buffer[1024];
-	uint8	*soundsnapshot = new uint8[SPC_SAVE_STATE_BLOCK_SIZE];
+	uint8	*soundsnapshot;
+
+	RENDER_SYNC();
 
         S9xPackStatus();
 
@@ -1333,8 +1375,9 @@ void S9xFreezeToStream (STREAM stream)
 
 	FreezeBlock (stream, "FIL", Memory.FillRAM, 0x8000);
 
+	soundsnapshot = FreezeBlockBegin(stream, "SND", SPC_SAVE_STATE_BLOCK_SIZE);
 	S9xAPUSaveState(soundsnapshot);
-	FreezeBlock (stream, "SND", soundsnapshot, SPC_SAVE_STATE_BLOCK_SIZE);
+	FreezeBlockEnd(stream, soundsnapshot, SPC_SAVE_STATE_BLOCK_SIZE);
 
 	struct SControlSnapshot	ctl_snap;
 	S9xControlPreSaveState(&ctl_snap);
@@ -1396,8 +1439,6 @@ void S9xFreezeToStream (STREAM stream)
 
     if (Settings.MSU1)
         FreezeStruct(stream, "MSU", &MSU1, SnapMSU1, COUNT(SnapMSU1));
-
-	delete [] soundsnapshot;
 }
 
 int S9xUnfreezeFromStream (STREAM stream)
@@ -1406,6 +1447,8 @@ int S9xUnfreezeFromStream (STREAM stream)
 	int		version, len;
 	char	buffer[PATH_MAX + 1];
 
+	RENDER_SYNC();
+
 	len = strlen(SNAPSHOT_MAGIC) + 1 + 4 + 1;
 	if (READ_STREAM(buffer, len, stream) != len)
 		return (WRONG_FORMAT);
@@ -1859,7 +1902,7 @@ static void FreezeStruct (STREAM stream, const char *name, void *base, FreezeDat
 			len += FreezeSize(fields[i].size, fields[i].type);
 	}
 
-	uint8	*block = new uint8[len];
+	uint8	*block = FreezeBlockBegin(stream, name, len);
 	uint8	*ptr = block;
 	uint8	*addr;
 	uint16	word;
@@ -1960,33 +2003,71 @@ static void FreezeStruct (STREAM stream, const char *name, void *base, FreezeDat
 		}
 	}
 
-	FreezeBlock(stream, name, block, len);
-	delete [] block;
+	FreezeBlockEnd(stream, block, len);
 }
 
-static void FreezeBlock (STREAM stream, const char *name, uint8 *block, int size)
+static void FreezeBlockHeader (STREAM stream, const char *name, int size)
 {
-	char	buffer[20];
+	char	buffer[11];
+
+	memcpy(buffer, name, 3);
+	buffer[3] = ':';
+	buffer[10] = ':';
 
 	// check if it fits in 6 digits. (letting it go over and using strlen isn't safe)
 	if (size <= 999999)
-		sprintf(buffer, "%s:%06d:", name, size);
+	{
+		for (int i = 9, digits = size; i >= 4; i--, digits /= 10)
+			buffer[i] = '0' + digits % 10;
+	}
 	else
 	{
 		// to make it fit, pack it in the bytes instead of as digits
-		sprintf(buffer, "%s:------:", name);
+		buffer[4] = buffer[5] = '-';
 		buffer[6] = (unsigned char) ((unsigned) size >> 24);
 		buffer[7] = (unsigned char) ((unsigned) size >> 16);
 		buffer[8] = (unsigned char) ((unsigned) size >> 8);
 		buffer[9] = (unsigned char) ((unsigned) size >> 0);
 	}
 
-	buffer[11] = 0;
-
 	WRITE_STREAM(buffer, 11, stream);
+}
+
+static void FreezeBlock (STREAM stream, const char *name, uint8 *block, int size)
+{
+	FreezeBlockHeader(stream, name, size);
 	WRITE_STREAM(block, size, stream);
 }
 
+// Blocks that are built up in place are written straight into the stream when
+// it allows that, and otherwise into a scratch buffer kept between snapshots.
+static uint8	*freeze_scratch = NULL;
+static int		freeze_scratch_size = 0;
+
+static uint8 * FreezeBlockBegin (STREAM stream, const char *name, int size)
+{
+	FreezeBlockHeader(stream, name, size);
+
+	uint8	*block = stream->reserve(size);
+	if (block)
+		return (block);
+
+	if (size > freeze_scratch_size)
+	{
+		delete [] freeze_scratch;
+		freeze_scratch = new uint8[size];
+		freeze_scratch_size = size;
+	}
+
+	return (freeze_scratch);
+}
+
+static void FreezeBlockEnd (STREAM stream, uint8 *block, int size)
+{
+	if (block == freeze_scratch)
+		WRITE_STREAM(block, size, stream);
+}
+
 static int UnfreezeBlock (STREAM stream, const char *name, uint8 *block, int size)
 {
 	char	buffer[20];
@@ -244,6 +244,14 @@ std::string Stream::getline (bool &eof)
 	return (ret);
 }
 
+// Hands out the next len bytes of the stream to be filled in place, skipping
+// past them. Streams that can't be written directly return NULL.
+
+uint8 * Stream::reserve (size_t len)
+{
+	return (NULL);
+}
+
 // snes9x.h FSTREAM Stream
 
 fStream::fStream (FSTREAM f)
@@ -500,6 +508,18 @@ size_t memStream::write (void *buf, size_t len)
 	return bytes;
 }
 
+uint8 * memStream::reserve (size_t len)
+{
+    if(readonly || len > remaining)
+        return NULL;
+
+    uint8 *block = head;
+    head += len;
+    remaining -= len;
+
+	return block;
+}
+
 size_t memStream::pos (void)
 {
     return msize - remaining;
@@ -201,6 +201,7 @@ class Stream
 		virtual std::string getline (bool &);
 		virtual size_t read (void *, size_t) = 0;
         virtual size_t write (void *, size_t) = 0;
+        virtual uint8 * reserve (size_t);
         virtual size_t pos (void) = 0;
         virtual size_t size (void) = 0;
         virtual int revert (size_t from, size_t offset) = 0;
@@ -264,6 +265,7 @@ class memStream : public Stream
 		virtual char * gets (char *, size_t);
 		virtual size_t read (void *, size_t);
         virtual size_t write (void *, size_t);
+        virtual uint8 * reserve (size_t);
         virtual size_t pos (void);
         virtual size_t size (void);
         virtual int revert (size_t from, size_t offset);
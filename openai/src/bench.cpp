@@ -0,0 +1,331 @@
+#include "coreinfo.h"
+#include "data.h"
+#include "emulator.h"
+#include "imageops.h"
+#include "json.hpp"
+#include "perf.h"
+#include "tool-utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+using namespace Retro;
+using namespace std;
+using nlohmann::json;
+
+using Clock = chrono::steady_clock;
+
+#ifndef RETRO_BENCH_CORE_HINT
+#define RETRO_BENCH_CORE_HINT "."
+#endif
+#ifndef RETRO_BENCH_COREINFO_DIR
+#define RETRO_BENCH_COREINFO_DIR ""
+#endif
+#ifndef RETRO_BENCH_ROM_DIR
+#define RETRO_BENCH_ROM_DIR "tests/roms"
+#endif
+
+// Frames emulated before measuring, so that boot screens and lazy core
+// initialization don't skew the results
+static const unsigned WARMUP_FRAMES = 60;
+
+// Number of variables watched by the synthetic scenario
+static const unsigned SCENARIO_VARIABLES = 16;
+
+struct Options {
+	unsigned frames = 1000;
+	unsigned iterations = 200;
+	bool perf = false;
+	string output;
+	string trace;
+	vector<string> roms;
+};
+
+// 16-byte blocks keep image rows aligned for the SIMD kernels
+struct alignas(16) ImageBlock {
+	uint8_t bytes[16];
+};
+
+static json benchmarkImage(Emulator& emulator, const Options& options) {
+	Image::Format format;
+	switch (emulator.getImageDepth()) {
+	case 16:
+		format = Image::Format::RGB565;
+		break;
+	case 32:
+		format = Image::Format::RGBX888;
+		break;
+	default:
+		return nullptr;
+	}
+
+	size_t w = emulator.getImageWidth();
+	size_t h = emulator.getImageHeight();
+	size_t pitch = emulator.getImagePitch();
+	const uint8_t* frame = static_cast<const uint8_t*>(emulator.getImageData());
+	if (!frame) {
+		return nullptr;
+	}
+
+	// Work on a copy of the frame with a spare row, since the kernels read
+	// whole vectors and some look past the last row
+	size_t stride = (pitch + 15) & ~size_t(15);
+	vector<ImageBlock> in((stride * (h + 1) + 15) / 16);
+	for (size_t y = 0; y < h; ++y) {
+		memcpy(&in[0].bytes[0] + y * stride, &frame[y * pitch], pitch);
+	}
+	Image source(format, static_cast<const void*>(in.data()), w, h, stride);
+
+	// The vectorized loops can write up to one vector past the end of a row
+	vector<ImageBlock> out((w * h * 3 + 48 + 15) / 16);
+
+	json results;
+	auto measure = [&](const char* name, function<void()> convert) {
+		try {
+			convert();
+		} catch (exception&) {
+			return;
+		}
+		auto start = Clock::now();
+		for (unsigned i = 0; i < options.iterations; ++i) {
+			convert();
+		}
+		double us = elapsedUs(start);
+		results[name] = {
+			{ "us", us / options.iterations },
+			{ "mpixels_per_sec", w * h * options.iterations / us },
+		};
+	};
+
+	measure("rgb888", [&]() {
+		Image rgb(Image::Format::RGB888, static_cast<void*>(out.data()), w, h, w * 3);
+		source.copyTo(&rgb);
+	});
+	measure("halve_gray", [&]() {
+		Image gray(Image::Format::G8, static_cast<void*>(out.data()), w / 2, h / 2, w / 2);
+		source.halveTo(&gray);
+	});
+	measure("quarter_gray", [&]() {
+		Image gray(Image::Format::G8, static_cast<void*>(out.data()), w / 4, h / 4, w / 4);
+		source.quarterTo(&gray);
+	});
+	measure("resize_84_gray", [&]() {
+		Image gray(Image::Format::G8, static_cast<void*>(out.data()), 84, 84, 84);
+		source.resizeTo(&gray);
+	});
+
+	return {
+		{ "width", w },
+		{ "height", h },
+		{ "depth", emulator.getImageDepth() },
+		{ "conversions", results },
+	};
+}
+
+static json benchmarkData(Emulator& emulator, const Options& options) {
+	GameData data;
+	Scenario scenario(data);
+	emulator.configureData(&data);
+
+	const auto& blocks = data.addressSpace().blocks();
+	if (blocks.empty()) {
+		return nullptr;
+	}
+
+	// Watch bytes spread across the first block of RAM, each worth a reward
+	// when it changes. The done condition can never be met.
+	size_t base = blocks.begin()->first;
+	size_t size = blocks.begin()->second.size();
+	for (unsigned i = 0; i < SCENARIO_VARIABLES; ++i) {
+		string name = "var" + to_string(i);
+		data.setVariable(name, Variable{ "|u1", base + size * i / SCENARIO_VARIABLES });
+		scenario.setRewardVariable(name, { Scenario::Measurement::DELTA, Operation::NOOP, 0, 1.f, 1.f });
+	}
+	scenario.setDoneVariable("var0", { Scenario::Measurement::ABSOLUTE, Operation::LESS_THAN, 0 });
+	data.updateRam();
+
+	double updateRamUs = 0;
+	double scenarioUs = 0;
+	for (unsigned i = 0; i < options.frames; ++i) {
+		emulator.run();
+
+		auto start = Clock::now();
+		data.updateRam();
+		updateRamUs += elapsedUs(start);
+
+		start = Clock::now();
+		scenario.update();
+		scenarioUs += elapsedUs(start);
+	}
+
+	size_t ramSize = 0;
+	for (const auto& block : blocks) {
+		ramSize += block.second.size();
+	}
+
+	return {
+		{ "ram_size", ramSize },
+		{ "variables", SCENARIO_VARIABLES },
+		{ "update_ram_us", updateRamUs / options.frames },
+		{ "scenario_update_us", scenarioUs / options.frames },
+	};
+}
+
+static json perfStats() {
+	json stages;
+	for (size_t i = 0; i < static_cast<size_t>(PerfStage::COUNT); ++i) {
+		PerfStage stage = static_cast<PerfStage>(i);
+		const PerfHistogram& hist = PerfStats::histogram(stage);
+		if (!hist.count) {
+			continue;
+		}
+		stages[perfStageName(stage)] = {
+			{ "count", hist.count },
+			{ "mean_us", hist.totalNs / 1000. / hist.count },
+			{ "p50_us", hist.percentileNs(0.5) / 1000. },
+			{ "p99_us", hist.percentileNs(0.99) / 1000. },
+			{ "max_us", hist.maxNs / 1000. },
+		};
+	}
+	return stages;
+}
+
+static json benchmarkRom(const string& rom, const Options& options) {
+	PerfStats::reset();
+	json result = {
+		{ "rom", rom.substr(rom.find_last_of('/') + 1) },
+		{ "core", coreForRom(rom) },
+	};
+
+	Emulator emulator;
+	auto start = Clock::now();
+	if (!emulator.loadRom(rom)) {
+		result["error"] = "failed to load ROM";
+		return result;
+	}
+	result["load_ms"] = elapsedUs(start) / 1000;
+
+	for (unsigned i = 0; i < WARMUP_FRAMES; ++i) {
+		emulator.run();
+	}
+
+	start = Clock::now();
+	for (unsigned i = 0; i < options.frames; ++i) {
+		emulator.run();
+	}
+	double runUs = elapsedUs(start);
+	result["run"] = {
+		{ "frames", options.frames },
+		{ "fps", options.frames * 1e6 / runUs },
+		{ "us_per_frame", runUs / options.frames },
+	};
+
+	size_t stateSize = emulator.serializeSize();
+	vector<uint8_t> state(stateSize);
+	double serializeUs = 0;
+	double unserializeUs = 0;
+	for (unsigned i = 0; i < options.iterations; ++i) {
+		start = Clock::now();
+		emulator.serialize(state.data(), state.size());
+		serializeUs += elapsedUs(start);
+
+		start = Clock::now();
+		emulator.unserialize(state.data(), state.size());
+		unserializeUs += elapsedUs(start);
+	}
+	result["state"] = {
+		{ "size", stateSize },
+		{ "serialize_us", serializeUs / options.iterations },
+		{ "unserialize_us", unserializeUs / options.iterations },
+	};
+
+	result["image"] = benchmarkImage(emulator, options);
+	result["data"] = benchmarkData(emulator, options);
+	if (options.perf) {
+		result["perf"] = perfStats();
+	}
+	return result;
+}
+
+static void usage(const char* argv0) {
+	cerr << "Usage: " << argv0 << " [-f FRAMES] [-i ITERATIONS] [-o OUTPUT] [-p] [-t TRACE] [ROM...]" << endl
+	     << endl
+	     << "Measures each ROM's core and prints the results as JSON. Without ROMs," << endl
+	     << "every ROM in " RETRO_BENCH_ROM_DIR " with a known core is measured." << endl
+	     << endl
+	     << "-p adds per-stage timings, which slow down the measurements slightly." << endl
+	     << "-t writes a Chrome trace of the last ROM's stages to TRACE." << endl;
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if ((arg == "-f" || arg == "-i" || arg == "-o" || arg == "-t") && i + 1 < argc) {
+			string value = argv[++i];
+			if (arg == "-f") {
+				options.frames = stoul(value);
+			} else if (arg == "-i") {
+				options.iterations = stoul(value);
+			} else if (arg == "-t") {
+				options.trace = value;
+				options.perf = true;
+			} else {
+				options.output = value;
+			}
+		} else if (arg == "-p") {
+			options.perf = true;
+		} else if (arg[0] == '-') {
+			usage(argv[0]);
+			return 1;
+		} else {
+			options.roms.emplace_back(arg);
+		}
+	}
+	if (!options.frames || !options.iterations) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (!loadCores(RETRO_BENCH_CORE_HINT, RETRO_BENCH_COREINFO_DIR)) {
+		cerr << "No core info found in " << corePath() << endl;
+		return 1;
+	}
+
+	if (options.roms.empty()) {
+		for (const auto& rom : listDirectory(RETRO_BENCH_ROM_DIR)) {
+			if (!coreForRom(rom).empty()) {
+				options.roms.emplace_back(rom);
+			}
+		}
+	}
+
+	PerfStats::setEnabled(options.perf, !options.trace.empty());
+
+	json results = json::array();
+	for (const auto& rom : options.roms) {
+		cerr << "Benchmarking " << rom << endl;
+		results.push_back(benchmarkRom(rom, options));
+	}
+
+	if (!options.trace.empty() && !PerfStats::writeTrace(options.trace)) {
+		cerr << "Could not write trace to " << options.trace << endl;
+	}
+
+	json report = {
+		{ "frames", options.frames },
+		{ "iterations", options.iterations },
+		{ "results", results },
+	};
+	if (options.output.empty()) {
+		cout << report.dump(2) << endl;
+	} else {
+		ofstream(options.output) << report.dump(2) << endl;
+	}
+	return 0;
+}
@@ -1,5 +1,6 @@
 #include "data.h"
 
+#include "perf.h"
 #include "script.h"
 #include "utils.h"
 
@@ -158,6 +159,7 @@ void GameData::reset() {
 	m_lastMem.reset();
 	m_cloneMem.reset();
 	m_vars.clear();
+	++m_varsRevision;
 	m_searches.clear();
 	m_searchOldMem.clear();
 }
@@ -167,6 +169,7 @@ void GameData::restart() {
 }
 
 void GameData::updateRam() {
+	PerfTimer timer(PerfStage::UPDATE_RAM);
 	m_lastMem = move(m_cloneMem);
 	m_cloneMem.clone(m_mem);
 }
@@ -227,6 +230,10 @@ int64_t GameData::lookupValue(const TypedSearchResult& result) const {
 	return m_mem[Variable{ result.type, result.address }];
 }
 
+bool GameData::isCustomValue(const string& name) const {
+	return m_customVars.count(name);
+}
+
 int64_t GameData::lookupDelta(const string& name) const {
 	const auto& v = m_vars.find(name);
 	if (v == m_vars.end()) {
@@ -309,12 +316,14 @@ Variable GameData::getVariable(const string& name) const {
 void GameData::setVariable(const string& name, const Variable& var) {
 	removeVariable(name);
 	m_vars.emplace(name, var);
+	++m_varsRevision;
 }
 
 void GameData::removeVariable(const string& name) {
 	auto iter = m_vars.find(name);
 	if (iter != m_vars.end()) {
 		m_vars.erase(iter);
+		++m_varsRevision;
 	}
 }
 
@@ -781,13 +790,63 @@ void Scenario::reset() {
 	}
 	m_doneVars.clear();
 	m_doneCondition = DoneCondition::ANY;
+	m_scripts.clear();
+	m_scriptContexts.clear();
+	clearScriptHandles();
+}
+
+ScriptContext* Scenario::scriptContext(const string& scope) const {
+	if (scope.empty() && m_scriptContexts.size() == 1) {
+		return m_scriptContexts.begin()->second.get();
+	}
+	const auto& found = m_scriptContexts.find(scope);
+	if (found == m_scriptContexts.end()) {
+		return nullptr;
+	}
+	return found->second.get();
+}
+
+ScriptContext* Scenario::createScriptContext(const string& scope) {
+	ScriptContext* context = scriptContext(scope);
+	if (context) {
+		return context;
+	}
+	shared_ptr<ScriptContext> created = ScriptContext::create(scope);
+	if (!created) {
+		return nullptr;
+	}
+	m_scriptContexts[scope] = created;
+	return created.get();
+}
+
+void Scenario::clearScriptHandles() {
+	for (unsigned i = 0; i < MAX_PLAYERS; ++i) {
+		m_rewardHandle[i] = ScriptContext::NO_FUNCTION;
+	}
+	m_doneHandle = ScriptContext::NO_FUNCTION;
+}
+
+Variant Scenario::callScript(const pair<string, string>& func, int* handle) const {
+	ScriptContext* context = scriptContext(func.second);
+	if (!context) {
+		throw runtime_error("No script loaded for function " + func.first);
+	}
+	if (*handle == ScriptContext::NO_FUNCTION) {
+		*handle = context->functionHandle(func.first);
+		if (*handle == ScriptContext::NO_FUNCTION) {
+			// Let the script report the missing function
+			return context->callFunction(func.first);
+		}
+	}
+	return context->callFunction(*handle);
 }
 
 bool Scenario::loadScript(const string& filename, const string& scope) {
-	auto context = ScriptContext::get(scope);
+	ScriptContext* context = createScriptContext(scope);
 	if (!context) {
 		return false;
 	}
+	clearScriptHandles();
 	context->setData(&m_data);
 	context->setScenario(this);
 	string path = filename;
@@ -819,10 +878,11 @@ bool Scenario::loadScript(const string& filename, const string& scope) {
 }
 
 void Scenario::reloadScripts() {
-	ScriptContext::reset();
+	m_scriptContexts.clear();
+	clearScriptHandles();
 
 	for (const auto& script : m_scripts) {
-		auto context = ScriptContext::get(script.second);
+		ScriptContext* context = createScriptContext(script.second);
 		if (!context) {
 			continue;
 		}
@@ -847,6 +907,7 @@ void Scenario::restart() {
 }
 
 void Scenario::update() {
+	PerfTimer timer(PerfStage::SCENARIO_UPDATE);
 	m_done = calculateDone();
 	for (unsigned i = 0; i < MAX_PLAYERS; ++i) {
 		m_reward[i] = calculateReward(i);
@@ -900,7 +961,7 @@ void Scenario::getCrop(size_t* x, size_t* y, size_t* width, size_t* height, unsi
 
 float Scenario::calculateReward(unsigned player) const {
 	if (m_rewardFunc[player].first.size()) {
-		return ScriptContext::get(m_rewardFunc[player].second)->callFunction(m_rewardFunc[player].first);
+		return callScript(m_rewardFunc[player], &m_rewardHandle[player]);
 	}
 
 	float reward = m_rewardTime[player].calculate(1, 1);
@@ -912,7 +973,7 @@ float Scenario::calculateReward(unsigned player) const {
 
 bool Scenario::calculateDone() const {
 	if (m_doneFunc.first.size()) {
-		return ScriptContext::get(m_doneFunc.second)->callFunction(m_doneFunc.first);
+		return callScript(m_doneFunc, &m_doneHandle);
 	}
 	for (auto var = m_doneVars.cbegin(); var != m_doneVars.cend(); ++var) {
 		int done = var->second.test(m_data.lookupValue(var->first), m_data.lookupDelta(var->first));
@@ -1047,6 +1108,7 @@ void Scenario::setRewardVariable(const string& name, const RewardSpec& var, unsi
 
 void Scenario::setRewardFunction(const string& name, const string& scope, unsigned player) {
 	m_rewardFunc[player] = make_pair(name, scope);
+	m_rewardHandle[player] = ScriptContext::NO_FUNCTION;
 }
 
 void Scenario::setRewardTime(const RewardSpec& spec, unsigned player) {
@@ -1067,6 +1129,7 @@ void Scenario::setDoneCondition(Scenario::DoneCondition condition) {
 
 void Scenario::setDoneFunction(const string& name, const string& scope) {
 	m_doneFunc = make_pair(name, scope);
+	m_doneHandle = ScriptContext::NO_FUNCTION;
 }
 
 unordered_map<string, Scenario::RewardSpec> Scenario::listRewardVariables(unsigned player) const {
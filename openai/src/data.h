@@ -16,6 +16,7 @@
 
 namespace Retro {
 
+class ScriptContext;
 class GameData {
 public:
 	bool load(const std::string& filename);
@@ -50,6 +51,7 @@ public:
 
 	void setValue(const std::string& name, int64_t);
 	void setValue(const std::string& name, const Variant&);
+	bool isCustomValue(const std::string& name) const;
 
 	int64_t lookupDelta(const std::string& name) const;
 
@@ -59,6 +61,8 @@ public:
 
 	std::unordered_map<std::string, Variable> listVariables() const;
 	size_t numVariables() const;
+	// Changes whenever a variable is defined or removed
+	uint64_t variablesRevision() const { return m_varsRevision; }
 
 	void search(const std::string& name, int64_t value);
 	void deltaSearch(const std::string& name, Operation op, int64_t reference);
@@ -83,6 +87,7 @@ private:
 	std::vector<std::string> m_buttons;
 
 	std::unordered_map<std::string, Variable> m_vars;
+	uint64_t m_varsRevision = 0;
 	std::unordered_map<std::string, Search> m_searches;
 	std::unordered_map<std::string, AddressSpace> m_searchOldMem;
 	std::unordered_map<std::string, std::unique_ptr<Variant>> m_customVars;
@@ -201,10 +206,19 @@ private:
 	float calculateReward(unsigned player) const;
 	bool calculateDone() const;
 
+	ScriptContext* scriptContext(const std::string& scope) const;
+	ScriptContext* createScriptContext(const std::string& scope);
+	Variant callScript(const std::pair<std::string, std::string>& func, int* handle) const;
+	void clearScriptHandles();
+
 	GameData& m_data;
 	std::string m_base;
 
 	std::vector<std::pair<std::string, std::string>> m_scripts;
+	std::unordered_map<std::string, std::shared_ptr<ScriptContext>> m_scriptContexts;
+	// Resolved reward and done functions, looked up on first call
+	mutable int m_rewardHandle[MAX_PLAYERS];
+	mutable int m_doneHandle;
 
 	std::unordered_map<std::string, RewardSpec> m_rewardVars[MAX_PLAYERS];
 	RewardSpec m_rewardTime[MAX_PLAYERS];
@@ -1,10 +1,15 @@
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#ifdef __SSSE3__
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
 #ifndef _WIN32
 #include <dlfcn.h>
 #endif
-#include <fstream>
 #include <map>
-#include <sstream>
 #include <unordered_map>
 #include <vector>
 
@@ -12,6 +17,8 @@
 #include "data.h"
 #include "emulator.h"
 #include "libretro.h"
+#include "perf.h"
+#include "rom.h"
 
 #ifndef _WIN32
 #define GETSYM dlsym
@@ -25,10 +32,18 @@ namespace Retro {
 
 static Emulator* s_loadedEmulator = nullptr;
 
+#ifdef RETRO_STATIC_CORE
+// Stands in for a library handle when the core is linked into the binary
+static char s_staticCore;
+#endif
+
 static map<string, const char*> s_envVariables = {
 	{ "genesis_plus_gx_bram", "per game" },
 	{ "genesis_plus_gx_render", "single field" },
-	{ "genesis_plus_gx_blargg_ntsc_filter", "disabled" }
+	{ "genesis_plus_gx_blargg_ntsc_filter", "disabled" },
+	{ "genesis_plus_gx_render_thread", "disabled" },
+	{ "snes9x_render_thread", "disabled" },
+	{ "gambatte_bulk_savestate", "disabled" }
 };
 
 static void (*retro_init)(void);
@@ -54,6 +69,20 @@ static void (*retro_set_audio_sample_batch)(retro_audio_sample_batch_t);
 static void (*retro_set_input_poll)(retro_input_poll_t);
 static void (*retro_set_input_state)(retro_input_state_t);
 
+#ifdef _WIN32
+static void closeCore(HMODULE handle) {
+	FreeLibrary(handle);
+}
+#else
+static void closeCore(void* handle) {
+#ifndef RETRO_STATIC_CORE
+	dlclose(handle);
+#else
+	(void) handle;
+#endif
+}
+#endif
+
 Emulator::Emulator() {
 }
 
@@ -87,6 +116,11 @@ bool Emulator::loadRom(const string& romPath) {
 		unloadCore();
 	}
 	if (!m_coreHandle) {
+#ifdef RETRO_STATIC_CORE
+		if (!loadCore({})) {
+			return false;
+		}
+#else
 		string lib = libForCore(core) + "_libretro.";
 #ifdef __APPLE__
 		lib += "dylib";
@@ -98,37 +132,33 @@ bool Emulator::loadRom(const string& romPath) {
 		if (!loadCore(corePath() + "/" + lib)) {
 			return false;
 		}
+#endif
 		m_core = core;
 	}
 
-	retro_game_info gameInfo;
-	ifstream in(romPath, ios::binary | ios::ate);
-	if (in.fail()) {
-		return false;
-	}
-	ostringstream out;
-	gameInfo.size = in.tellg();
-	if (in.fail()) {
-		return false;
-	}
-	char* romData = new char[gameInfo.size];
+	retro_game_info gameInfo{};
 	gameInfo.path = romPath.c_str();
-	gameInfo.data = romData;
-	in.seekg(0, ios::beg);
-	in.read(romData, gameInfo.size);
-	if (in.fail()) {
-		delete[] romData;
-		return false;
+	retro_system_info systemInfo;
+	retro_get_system_info(&systemInfo);
+	if (!systemInfo.need_fullpath) {
+		// Kept after unloading, so reloading the same ROM reuses the mapping
+		m_rom = RomData::load(romPath);
+		if (!m_rom) {
+			return false;
+		}
+		gameInfo.data = m_rom->data();
+		gameInfo.size = m_rom->size();
 	}
-	in.close();
 
-	auto res = retro_load_game(&gameInfo);
-	delete[] romData;
-	if (!res) {
+	m_fixedGeometry = false;
+	m_audioChannels = 2;
+	if (!retro_load_game(&gameInfo)) {
 		return false;
 	}
 	retro_get_system_av_info(&m_avInfo);
-	fixScreenSize(romPath);
+	if (!m_fixedGeometry) {
+		fixScreenSize(romPath);
+	}
 
 	m_romLoaded = true;
 	m_romPath = romPath;
@@ -138,6 +168,8 @@ bool Emulator::loadRom(const string& romPath) {
 void Emulator::run() {
 	assert(s_loadedEmulator == this);
 	m_audioData.clear();
+	m_stereoAudioReady = false;
+	PerfTimer timer(PerfStage::CORE_RUN);
 	retro_run();
 }
 
@@ -146,27 +178,6 @@ void Emulator::reset() {
 
 	memset(m_buttonMask, 0, sizeof(m_buttonMask));
 
-	retro_system_info systemInfo;
-	retro_get_system_info(&systemInfo);
-	if (!strcmp(systemInfo.library_name, "Stella")) {
-		// Stella does not properly clear everything when reseting or loading a savestate
-		string romPath = m_romPath;
-
-#ifdef _WIN32
-		FreeLibrary(m_coreHandle);
-#else
-		dlclose(m_coreHandle);
-#endif
-		m_coreHandle = nullptr;
-		s_loadedEmulator = nullptr;
-		m_romLoaded = false;
-		loadRom(m_romPath);
-		if (m_addressSpace) {
-			m_addressSpace->reset();
-			m_addressSpace->addBlock(Retro::ramBase(m_core), retro_get_memory_size(RETRO_MEMORY_SYSTEM_RAM), retro_get_memory_data(RETRO_MEMORY_SYSTEM_RAM));
-		}
-	}
-
 	retro_reset();
 }
 
@@ -178,11 +189,7 @@ void Emulator::unloadCore() {
 		unloadRom();
 	}
 	retro_deinit();
-#ifdef _WIN32
-	FreeLibrary(m_coreHandle);
-#else
-	dlclose(m_coreHandle);
-#endif
+	closeCore(m_coreHandle);
 	m_coreHandle = nullptr;
 	s_loadedEmulator = nullptr;
 }
@@ -196,6 +203,10 @@ void Emulator::unloadRom() {
 	m_romPath.clear();
 	m_addressSpace = nullptr;
 	m_map.clear();
+	m_indexedData = nullptr;
+	m_palette = nullptr;
+	m_composeFrame = nullptr;
+	m_framePending = false;
 }
 
 bool Emulator::serialize(void* data, size_t size) {
@@ -206,12 +217,6 @@ bool Emulator::serialize(void* data, size_t size) {
 bool Emulator::unserialize(const void* data, size_t size) {
 	assert(s_loadedEmulator == this);
 	try {
-		retro_system_info systemInfo;
-		retro_get_system_info(&systemInfo);
-		if (!strcmp(systemInfo.library_name, "Stella")) {
-			reset();
-		}
-
 		return retro_unserialize(data, size);
 	} catch (...) {
 		return false;
@@ -223,6 +228,121 @@ size_t Emulator::serializeSize() {
 	return retro_serialize_size();
 }
 
+// Delta format: the varint state size, then (skip, length, bytes) runs of
+// varints and XORed bytes. Bytes past the end of the base XOR against zero.
+// Equal stretches shorter than this are folded into the surrounding run
+static const size_t DELTA_MIN_SKIP = 4;
+
+static void putVarint(vector<uint8_t>* out, size_t value) {
+	while (value >= 0x80) {
+		out->push_back(value | 0x80);
+		value >>= 7;
+	}
+	out->push_back(value);
+}
+
+static bool getVarint(const uint8_t** in, const uint8_t* end, size_t* value) {
+	*value = 0;
+	for (unsigned shift = 0; *in < end && shift < sizeof(size_t) * 8; shift += 7) {
+		uint8_t byte = *(*in)++;
+		*value |= static_cast<size_t>(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static size_t skipEqual(const uint8_t* state, const uint8_t* base, size_t pos, size_t end) {
+	while (pos + sizeof(uint64_t) <= end) {
+		uint64_t a, b;
+		memcpy(&a, &state[pos], sizeof(a));
+		memcpy(&b, &base[pos], sizeof(b));
+		if (a != b) {
+			break;
+		}
+		pos += sizeof(uint64_t);
+	}
+	while (pos < end && state[pos] == base[pos]) {
+		++pos;
+	}
+	return pos;
+}
+
+bool Emulator::snapshotDelta(const void* base, size_t baseSize, vector<uint8_t>* delta) {
+	assert(s_loadedEmulator == this);
+	size_t size = serializeSize();
+	m_deltaState.resize(size);
+	if (!serialize(m_deltaState.data(), size)) {
+		return false;
+	}
+
+	const uint8_t* state = m_deltaState.data();
+	const uint8_t* old = static_cast<const uint8_t*>(base);
+	size_t common = min(size, baseSize);
+	delta->clear();
+	putVarint(delta, size);
+
+	size_t pos = 0;
+	while (pos < size) {
+		size_t start = pos < common ? skipEqual(state, old, pos, common) : pos;
+		if (start == size) {
+			break;
+		}
+		size_t end = start + 1;
+		while (end < size) {
+			if (end >= common) {
+				end = size;
+				break;
+			}
+			size_t next = skipEqual(state, old, end, common);
+			if (next - end >= DELTA_MIN_SKIP || next == size) {
+				break;
+			}
+			end = next + 1;
+		}
+		putVarint(delta, start - pos);
+		putVarint(delta, end - start);
+		for (size_t i = start; i < end; ++i) {
+			delta->push_back(i < common ? state[i] ^ old[i] : state[i]);
+		}
+		pos = end;
+	}
+	return true;
+}
+
+bool Emulator::restoreDelta(const void* base, size_t baseSize, const void* delta, size_t deltaSize) {
+	assert(s_loadedEmulator == this);
+	const uint8_t* in = static_cast<const uint8_t*>(delta);
+	const uint8_t* end = in + deltaSize;
+	size_t size;
+	if (!getVarint(&in, end, &size)) {
+		return false;
+	}
+
+	m_deltaState.resize(size);
+	size_t common = min(size, baseSize);
+	memcpy(m_deltaState.data(), base, common);
+	memset(m_deltaState.data() + common, 0, size - common);
+
+	size_t pos = 0;
+	while (in < end) {
+		size_t skip;
+		size_t length;
+		if (!getVarint(&in, end, &skip) || !getVarint(&in, end, &length)) {
+			return false;
+		}
+		if (skip > size - pos || length > size - pos - skip || length > static_cast<size_t>(end - in)) {
+			return false;
+		}
+		pos += skip;
+		for (size_t i = 0; i < length; ++i) {
+			m_deltaState[pos++] ^= *in++;
+		}
+	}
+	return unserialize(m_deltaState.data(), size);
+}
+
 void Emulator::clearCheats() {
 	assert(s_loadedEmulator == this);
 	retro_cheat_reset();
@@ -238,6 +358,41 @@ bool Emulator::loadCore(const string& corePath) {
 		return false;
 	}
 
+	// Cores that can draw frames on a helper thread only do so when asked to
+	const char* renderThread = getenv("RETRO_RENDER_THREAD") ? "enabled" : "disabled";
+	s_envVariables["genesis_plus_gx_render_thread"] = renderThread;
+	s_envVariables["snes9x_render_thread"] = renderThread;
+
+	// Bulk savestates are faster but only load into the same core build
+	s_envVariables["gambatte_bulk_savestate"] = getenv("RETRO_BULK_SAVESTATE") ? "enabled" : "disabled";
+
+#ifdef RETRO_STATIC_CORE
+	(void) corePath;
+	m_coreHandle = &s_staticCore;
+
+	retro_init = ::retro_init;
+	retro_deinit = ::retro_deinit;
+	retro_api_version = ::retro_api_version;
+	retro_get_system_info = ::retro_get_system_info;
+	retro_get_system_av_info = ::retro_get_system_av_info;
+	retro_reset = ::retro_reset;
+	retro_run = ::retro_run;
+	retro_serialize_size = ::retro_serialize_size;
+	retro_serialize = ::retro_serialize;
+	retro_unserialize = ::retro_unserialize;
+	retro_load_game = ::retro_load_game;
+	retro_unload_game = ::retro_unload_game;
+	retro_get_memory_data = ::retro_get_memory_data;
+	retro_get_memory_size = ::retro_get_memory_size;
+	retro_cheat_reset = ::retro_cheat_reset;
+	retro_cheat_set = ::retro_cheat_set;
+	retro_set_environment = ::retro_set_environment;
+	retro_set_video_refresh = ::retro_set_video_refresh;
+	retro_set_audio_sample = ::retro_set_audio_sample;
+	retro_set_audio_sample_batch = ::retro_set_audio_sample_batch;
+	retro_set_input_poll = ::retro_set_input_poll;
+	retro_set_input_state = ::retro_set_input_state;
+#else
 #ifdef _WIN32
 	m_coreHandle = LoadLibrary(corePath.c_str());
 #else
@@ -269,6 +424,7 @@ bool Emulator::loadCore(const string& corePath) {
 	retro_set_audio_sample_batch = reinterpret_cast<void (*)(retro_audio_sample_batch_t)>(GETSYM(m_coreHandle, "retro_set_audio_sample_batch"));
 	retro_set_input_poll = reinterpret_cast<void (*)(retro_input_poll_t)>(GETSYM(m_coreHandle, "retro_set_input_poll"));
 	retro_set_input_state = reinterpret_cast<void (*)(short (*)(unsigned int, unsigned int, unsigned int, unsigned int))>(GETSYM(m_coreHandle, "retro_set_input_state"));
+#endif
 
 	// The default according to the docs
 	m_imgDepth = 15;
@@ -335,6 +491,42 @@ void Emulator::reconfigureAddressSpace() {
 	}
 }
 
+void Emulator::composeFrame() {
+	assert(s_loadedEmulator == this);
+	m_framePending = false;
+	m_composeFrame();
+}
+
+const int16_t* Emulator::stereoAudioData() {
+	if (m_stereoAudioReady) {
+		return m_stereoAudio.data();
+	}
+	size_t samples = m_audioData.size();
+	m_stereoAudio.resize(samples * 2);
+	const int16_t* in = m_audioData.data();
+	int16_t* out = m_stereoAudio.data();
+	size_t i = 0;
+#ifdef __SSSE3__
+	for (; i + 8 <= samples; i += 8) {
+		__m128i mono = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i * 2]), _mm_unpacklo_epi16(mono, mono));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i * 2 + 8]), _mm_unpackhi_epi16(mono, mono));
+	}
+#elif defined(__wasm_simd128__)
+	for (; i + 8 <= samples; i += 8) {
+		v128_t mono = wasm_v128_load(&in[i]);
+		wasm_v128_store(&out[i * 2], wasm_i16x8_shuffle(mono, mono, 0, 8, 1, 9, 2, 10, 3, 11));
+		wasm_v128_store(&out[i * 2 + 8], wasm_i16x8_shuffle(mono, mono, 4, 12, 5, 13, 6, 14, 7, 15));
+	}
+#endif
+	for (; i < samples; ++i) {
+		out[i * 2] = in[i];
+		out[i * 2 + 1] = in[i];
+	}
+	m_stereoAudioReady = true;
+	return m_stereoAudio.data();
+}
+
 bool Emulator::cbEnvironment(unsigned cmd, void* data) {
 	assert(s_loadedEmulator);
 	switch (cmd) {
@@ -378,6 +570,28 @@ bool Emulator::cbEnvironment(unsigned cmd, void* data) {
 		}
 		s_loadedEmulator->reconfigureAddressSpace();
 		return true;
+	case RETRO_ENVIRONMENT_RETRO_SET_INDEXED_FRAME: {
+		const retro_indexed_frame* frame = static_cast<const retro_indexed_frame*>(data);
+		s_loadedEmulator->m_indexedData = frame->data;
+		s_loadedEmulator->m_indexedWidth = frame->width;
+		s_loadedEmulator->m_indexedHeight = frame->height;
+		s_loadedEmulator->m_indexedPitch = frame->pitch;
+		s_loadedEmulator->m_palette = frame->palette;
+		return true;
+	}
+	case RETRO_ENVIRONMENT_RETRO_GET_INDEXED_ONLY:
+		*reinterpret_cast<bool*>(data) = s_loadedEmulator->m_indexedOnly;
+		return true;
+	case RETRO_ENVIRONMENT_RETRO_SET_FRAME_COMPOSER:
+		s_loadedEmulator->m_composeFrame = static_cast<const retro_frame_composer*>(data)->compose;
+		return true;
+	case RETRO_ENVIRONMENT_RETRO_SET_AUDIO_MONO:
+		s_loadedEmulator->m_audioChannels = *reinterpret_cast<const bool*>(data) ? 1 : 2;
+		return true;
+	case RETRO_ENVIRONMENT_RETRO_GET_FIXED_GEOMETRY:
+		*reinterpret_cast<bool*>(data) = true;
+		s_loadedEmulator->m_fixedGeometry = true;
+		return true;
 	default:
 		return false;
 	}
@@ -386,9 +600,13 @@ bool Emulator::cbEnvironment(unsigned cmd, void* data) {
 
 void Emulator::cbVideoRefresh(const void* data, unsigned, unsigned, size_t pitch) {
 	assert(s_loadedEmulator);
+	PerfTimer timer(PerfStage::VIDEO_REFRESH);
 	if (data) {
 		s_loadedEmulator->m_imgData = data;
 	}
+	if (s_loadedEmulator->m_composeFrame) {
+		s_loadedEmulator->m_framePending = true;
+	}
 	if (pitch) {
 		s_loadedEmulator->m_imgPitch = pitch;
 	}
@@ -397,12 +615,15 @@ void Emulator::cbVideoRefresh(const void* data, unsigned, unsigned, size_t pitch
 void Emulator::cbAudioSample(int16_t left, int16_t right) {
 	assert(s_loadedEmulator);
 	s_loadedEmulator->m_audioData.push_back(left);
-	s_loadedEmulator->m_audioData.push_back(right);
+	if (s_loadedEmulator->m_audioChannels == 2) {
+		s_loadedEmulator->m_audioData.push_back(right);
+	}
 }
 
 size_t Emulator::cbAudioSampleBatch(const int16_t* data, size_t frames) {
 	assert(s_loadedEmulator);
-	s_loadedEmulator->m_audioData.insert(s_loadedEmulator->m_audioData.end(), data, &data[frames * 2]);
+	PerfTimer timer(PerfStage::AUDIO_BATCH);
+	s_loadedEmulator->m_audioData.insert(s_loadedEmulator->m_audioData.end(), data, &data[frames * s_loadedEmulator->m_audioChannels]);
 	return frames;
 }
 
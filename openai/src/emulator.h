@@ -3,6 +3,7 @@
 #include "libretro.h"
 #include "memory.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <cstring>
@@ -11,12 +12,49 @@
 #include <windows.h>
 #endif
 
+// Private environment commands for cores that can hand over their frames
+// before expanding them to RGB. A core that supports them calls
+// SET_INDEXED_FRAME every frame, and may skip the RGB frame (sending a
+// duplicate instead) when GET_INDEXED_ONLY says the frontend doesn't need it.
+#define RETRO_ENVIRONMENT_RETRO_SET_INDEXED_FRAME (1 | RETRO_ENVIRONMENT_PRIVATE)
+#define RETRO_ENVIRONMENT_RETRO_GET_INDEXED_ONLY (2 | RETRO_ENVIRONMENT_PRIVATE)
+
+struct retro_indexed_frame {
+	const uint8_t* data; // One palette index per pixel
+	unsigned width;
+	unsigned height;
+	size_t pitch;
+	const uint8_t* palette; // 256 RGB888 entries
+};
+
+// Private environment command for cores that can put off drawing a frame
+// until somebody looks at it. The core keeps sending frames as usual, but
+// their pixels are only valid once the registered compose callback has run,
+// which getImageData does the first time each frame is read.
+#define RETRO_ENVIRONMENT_RETRO_SET_FRAME_COMPOSER (3 | RETRO_ENVIRONMENT_PRIVATE)
+
+struct retro_frame_composer {
+	void (*compose)(void);
+};
+
+// Private environment command for cores whose frame size otherwise follows
+// the emulated video mode. A core asks once while loading a game; when the
+// frontend says yes, it reports its largest frame in the AV info, sends every
+// frame at that size with tightly packed lines, and stops polling variables.
+#define RETRO_ENVIRONMENT_RETRO_GET_FIXED_GEOMETRY (4 | RETRO_ENVIRONMENT_PRIVATE)
+
+// Private environment command for cores with a single audio channel. A core
+// that sends it (with a bool set to true) and gets true back passes one sample
+// per frame to audio_sample_batch from then on, instead of left/right pairs.
+#define RETRO_ENVIRONMENT_RETRO_SET_AUDIO_MONO (5 | RETRO_ENVIRONMENT_PRIVATE)
+
 namespace Retro {
 
 const int N_BUTTONS = 16;
 const int MAX_PLAYERS = 2;
 
 class GameData;
+class RomData;
 class Emulator {
 public:
 	Emulator();
@@ -30,15 +68,40 @@ public:
 	void run();
 	void reset();
 	AddressSpace* getAddressSpace();
-	const void* getImageData() { return m_imgData; }
+	const void* getImageData() {
+		if (m_framePending) {
+			composeFrame();
+		}
+		return m_imgData;
+	}
 	int getImageHeight() { return m_avInfo.geometry.base_height; }
 	int getImageWidth() { return m_avInfo.geometry.base_width; }
 	int getImagePitch() { return m_imgPitch; }
 	int getImageDepth() { return m_imgDepth; }
+
+	// Palette-indexed frame, only available with cores that provide one
+	bool hasIndexedImage() { return m_indexedData; }
+	const uint8_t* getIndexedImageData() { return m_indexedData; }
+	int getIndexedImageHeight() { return m_indexedHeight; }
+	int getIndexedImageWidth() { return m_indexedWidth; }
+	int getIndexedImagePitch() { return m_indexedPitch; }
+	const uint8_t* getPalette() { return m_palette; }
+	// Lets the core skip the RGB frame, leaving getImageData stale
+	void setIndexedOnly(bool indexedOnly) { m_indexedOnly = indexedOnly; }
+	bool indexedOnly() { return m_indexedOnly; }
 	double getFrameRate() { return m_avInfo.timing.fps; }
-	int getAudioSamples() { return m_audioData.size() / 2; }
+	int getAudioSamples() { return m_audioData.size() / m_audioChannels; }
 	double getAudioRate() { return m_avInfo.timing.sample_rate; }
-	const int16_t* getAudioData() { return m_audioData.data(); }
+	// Interleaved stereo; mono audio is duplicated into both channels on first use
+	const int16_t* getAudioData() {
+		if (m_audioChannels == 1) {
+			return stereoAudioData();
+		}
+		return m_audioData.data();
+	}
+	// Audio as the core sent it, getAudioChannels() samples per frame
+	int getAudioChannels() { return m_audioChannels; }
+	const int16_t* getRawAudioData() { return m_audioData.data(); }
 	void unloadCore();
 	void unloadRom();
 
@@ -46,6 +109,12 @@ public:
 	bool unserialize(const void* data, size_t size);
 	size_t serializeSize();
 
+	// Delta savestates: the current state XORed against a base state from
+	// serialize() and run-length encoded, so per-frame checkpoints only cost
+	// as much as the bytes that changed since the base
+	bool snapshotDelta(const void* base, size_t baseSize, std::vector<uint8_t>* delta);
+	bool restoreDelta(const void* base, size_t baseSize, const void* delta, size_t deltaSize);
+
 	void setKey(int port, int key, bool active) { m_buttonMask[port][key] = active; }
 	bool getKey(int port, int key) { return m_buttonMask[port][key]; }
 
@@ -61,6 +130,8 @@ private:
 	bool loadCore(const std::string& corePath);
 	void fixScreenSize(const std::string& romName);
 	void reconfigureAddressSpace();
+	void composeFrame();
+	const int16_t* stereoAudioData();
 
 	static bool cbEnvironment(unsigned cmd, void* data);
 	static void cbVideoRefresh(const void* data, unsigned width, unsigned height, size_t pitch);
@@ -75,11 +146,29 @@ private:
 	const void* m_imgData = nullptr;
 	size_t m_imgPitch = 0;
 	int m_imgDepth = 0;
+	void (*m_composeFrame)() = nullptr;
+	bool m_framePending = false;
+	bool m_fixedGeometry = false;
+
+	// Indexed frame info
+	const uint8_t* m_indexedData = nullptr;
+	unsigned m_indexedWidth = 0;
+	unsigned m_indexedHeight = 0;
+	size_t m_indexedPitch = 0;
+	const uint8_t* m_palette = nullptr;
+	bool m_indexedOnly = false;
 
 	// Audio buffer; accumulated during run()
 	std::vector<int16_t> m_audioData;
+	int m_audioChannels = 2;
+	// Mono audio duplicated to stereo, valid while m_stereoAudioReady
+	std::vector<int16_t> m_stereoAudio;
+	bool m_stereoAudioReady = false;
 	AddressSpace* m_addressSpace = nullptr;
 
+	// Scratch state for encoding and decoding deltas
+	std::vector<uint8_t> m_deltaState;
+
 	retro_system_av_info m_avInfo = {};
 	std::vector<retro_memory_descriptor> m_map;
 
@@ -93,5 +182,6 @@ private:
 	bool m_romLoaded = false;
 	std::string m_core;
 	std::string m_romPath;
+	std::shared_ptr<const RomData> m_rom;
 };
 }
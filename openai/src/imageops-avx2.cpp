@@ -0,0 +1,355 @@
+#include "imageops-avx2.h"
+
+#include <immintrin.h>
+
+using namespace Retro;
+
+/* Most AVX2 integer instructions operate on two independent 128-bit lanes. Each
+ * kernel here loads two blocks of pixels that the SSSE3 kernels would handle one
+ * at a time, one per lane, so that the per-lane steps are exactly the SSSE3 ones
+ * and the results are identical.
+ *
+ * Constants are built inside the functions rather than as statics, since static
+ * initializers would run AVX2 code on CPUs that don't support it.
+ */
+
+static inline __m256i _load2(const void* lo, const void* hi) {
+	__m128i a = _mm_loadu_si128(static_cast<const __m128i*>(lo));
+	__m128i b = _mm_loadu_si128(static_cast<const __m128i*>(hi));
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(a), b, 1);
+}
+
+static inline __m256i _broadcast(__m128i a) {
+	return _mm256_broadcastsi128_si256(a);
+}
+
+/* Store 16 16-bit values as bytes */
+static inline void _store16(uint8_t* out, __m256i a) {
+	__m128i out0 = _mm_packus_epi16(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out), out0);
+}
+
+/* Store 8 32-bit values as bytes */
+static inline void _store8(uint8_t* out, __m256i a) {
+	__m128i out0 = _mm_packs_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+	out0 = _mm_packus_epi16(out0, out0);
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(out), out0);
+}
+
+/* Store three registers of packed RGB, each holding the output of two lanes */
+static inline void _store888(uint8_t* out, __m256i out0, __m256i out1, __m256i out2) {
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[0]), _mm256_permute2x128_si256(out0, out1, 0x20));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[32]), _mm256_permute2x128_si256(out2, out0, 0x30));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[64]), _mm256_permute2x128_si256(out1, out2, 0x31));
+}
+
+static inline __m256i _convert565ToGray(__m256i pix) {
+	/* Mask out channels */
+	__m256i r = _mm256_and_si256(pix, _mm256_set1_epi16(0xF800));
+	__m256i g = _mm256_and_si256(pix, _mm256_set1_epi16(0x07E0));
+	__m256i b = _mm256_and_si256(pix, _mm256_set1_epi16(0x001F));
+	/* Normalize channels */
+	r = _mm256_srli_epi16(r, 10);
+	g = _mm256_srli_epi16(g, 5);
+	b = _mm256_slli_epi16(b, 1);
+	/* Combine channels */
+	r = _mm256_add_epi16(r, g);
+	r = _mm256_add_epi16(r, b);
+	return r;
+}
+
+static inline __m256i _convertX888ToGray(__m256i pix) {
+	const __m256i maskR32 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x0E, 0x80, 0x80, 0x80, 0x0A, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80, 0x02));
+	const __m256i maskG32 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x0D, 0x80, 0x80, 0x80, 0x09, 0x80, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80, 0x01));
+	const __m256i maskB32 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x0C, 0x80, 0x80, 0x80, 0x08, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x00));
+	/* Mask out channels */
+	__m256i r = _mm256_shuffle_epi8(pix, maskR32);
+	__m256i g = _mm256_shuffle_epi8(pix, maskG32);
+	__m256i b = _mm256_shuffle_epi8(pix, maskB32);
+	/* Combine channels */
+	r = _mm256_add_epi32(r, g);
+	r = _mm256_add_epi32(r, b);
+	r = _mm256_srli_epi16(r, 2);
+	return r;
+}
+
+static inline __m256i _halveWNeighbor16(__m256i a, __m256i b) {
+	/* Swizzle ABCDEFGH IJKLMNOP to ACEGBDFH IKMOJLNP in each lane */
+	a = _mm256_shufflelo_epi16(a, 0xD8);
+	a = _mm256_shufflehi_epi16(a, 0xD8);
+	a = _mm256_shuffle_epi32(a, 0xD8);
+	b = _mm256_shufflelo_epi16(b, 0xD8);
+	b = _mm256_shufflehi_epi16(b, 0xD8);
+	b = _mm256_shuffle_epi32(b, 0xD8);
+	return _mm256_unpacklo_epi64(a, b); /* ACEGIKMO */
+}
+
+static inline __m256i _halveW16(__m256i a, __m256i b) {
+	/* Swizzle ABCDEFGH IJKLMNOP to ACEGBDFH IKMOJLNP in each lane */
+	a = _mm256_shufflelo_epi16(a, 0xD8);
+	a = _mm256_shufflehi_epi16(a, 0xD8);
+	a = _mm256_shuffle_epi32(a, 0xD8);
+	b = _mm256_shufflelo_epi16(b, 0xD8);
+	b = _mm256_shufflehi_epi16(b, 0xD8);
+	b = _mm256_shuffle_epi32(b, 0xD8);
+	/* Halve width */
+	return _mm256_avg_epu16(_mm256_unpacklo_epi64(a, b), _mm256_unpackhi_epi64(a, b));
+}
+
+static inline __m256i _halveWNeighbor32(__m256i a, __m256i b) {
+	/* Swizzle ABCD EFGH to ACEG in each lane */
+	a = _mm256_shuffle_epi32(a, 0xD8);
+	b = _mm256_shuffle_epi32(b, 0xD8);
+	return _mm256_unpacklo_epi64(a, b);
+}
+
+static inline __m256i _halveW32(__m256i a, __m256i b) {
+	/* Swizzle ABCD EFGH to ACEG BDFH in each lane */
+	a = _mm256_shuffle_epi32(a, 0xD8);
+	b = _mm256_shuffle_epi32(b, 0xD8);
+	/* Halve width */
+	return _mm256_avg_epu16(_mm256_unpacklo_epi64(a, b), _mm256_unpackhi_epi64(a, b));
+}
+
+size_t Retro::imageHalve565ToGrayAVX2(const uint16_t* in, uint8_t* out, size_t w, size_t stride) {
+	size_t x = 0;
+	for (; x + 31 < w; x += 32) {
+		__m256i gray0;
+		__m256i gray1;
+
+		gray0 = _convert565ToGray(_load2(&in[x], &in[x + 16]));
+		gray1 = _convert565ToGray(_load2(&in[x + 8], &in[x + 24]));
+		__m256i out0 = _halveW16(gray0, gray1);
+
+		gray0 = _convert565ToGray(_load2(&in[x + stride / 2], &in[x + 16 + stride / 2]));
+		gray1 = _convert565ToGray(_load2(&in[x + 8 + stride / 2], &in[x + 24 + stride / 2]));
+		__m256i out1 = _halveW16(gray0, gray1);
+
+		// Halve height
+		_store16(out, _mm256_avg_epu16(out0, out1));
+		out += 16;
+	}
+	return x;
+}
+
+size_t Retro::imageQuarter565ToGrayAVX2(const uint16_t* in, uint8_t* out, size_t w, size_t stride) {
+	size_t x = 0;
+	for (; x + 63 < w; x += 64) {
+		__m256i gray0;
+		__m256i gray1;
+
+		gray0 = _halveWNeighbor16(_load2(&in[x], &in[x + 32]), _load2(&in[x + 8], &in[x + 40]));
+		gray1 = _halveWNeighbor16(_load2(&in[x + 16], &in[x + 48]), _load2(&in[x + 24], &in[x + 56]));
+		__m256i out0 = _halveW16(_convert565ToGray(gray0), _convert565ToGray(gray1));
+
+		gray0 = _halveWNeighbor16(_load2(&in[x + stride], &in[x + 32 + stride]), _load2(&in[x + 8 + stride], &in[x + 40 + stride]));
+		gray1 = _halveWNeighbor16(_load2(&in[x + 16 + stride], &in[x + 48 + stride]), _load2(&in[x + 24 + stride], &in[x + 56 + stride]));
+		__m256i out1 = _halveW16(_convert565ToGray(gray0), _convert565ToGray(gray1));
+
+		// Halve height
+		_store16(out, _mm256_avg_epu16(out0, out1));
+		out += 16;
+	}
+	return x;
+}
+
+size_t Retro::image565To888AVX2(const uint16_t* in, uint8_t* out, size_t w) {
+	/* See _convert565To888 in imageops.cpp for the layout of each mask */
+	const __m256i rblend00 = _broadcast(_mm_set_epi8(0x0A, 0x80, 0x80, 0x08, 0x80, 0x80, 0x06, 0x80, 0x80, 0x04, 0x80, 0x80, 0x02, 0x80, 0x80, 0x00));
+	const __m256i rblend10 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0E, 0x80, 0x80, 0x0C, 0x80, 0x80));
+	const __m256i rblend11 = _broadcast(_mm_set_epi8(0x80, 0x04, 0x80, 0x80, 0x02, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80));
+	const __m256i rblend21 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x0E, 0x80, 0x80, 0x0C, 0x80, 0x80, 0x0A, 0x80, 0x80, 0x08, 0x80, 0x80, 0x06, 0x80));
+	const __m256i gblend00 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x08, 0x80, 0x80, 0x06, 0x80, 0x80, 0x04, 0x80, 0x80, 0x02, 0x80, 0x80, 0x00, 0x80));
+	const __m256i gblend10 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0E, 0x80, 0x80, 0x0C, 0x80, 0x80, 0x0A));
+	const __m256i gblend11 = _broadcast(_mm_set_epi8(0x04, 0x80, 0x80, 0x02, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80));
+	const __m256i gblend21 = _broadcast(_mm_set_epi8(0x80, 0x0E, 0x80, 0x80, 0x0C, 0x80, 0x80, 0x0A, 0x80, 0x80, 0x08, 0x80, 0x80, 0x06, 0x80, 0x80));
+	const __m256i bblend00 = _broadcast(_mm_set_epi8(0x80, 0x08, 0x80, 0x80, 0x06, 0x80, 0x80, 0x04, 0x80, 0x80, 0x02, 0x80, 0x80, 0x00, 0x80, 0x80));
+	const __m256i bblend10 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0E, 0x80, 0x80, 0x0C, 0x80, 0x80, 0x0A, 0x80));
+	const __m256i bblend11 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x02, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80));
+	const __m256i bblend21 = _broadcast(_mm_set_epi8(0x0E, 0x80, 0x80, 0x0C, 0x80, 0x80, 0x0A, 0x80, 0x80, 0x08, 0x80, 0x80, 0x06, 0x80, 0x80, 0x04));
+	const __m256i maskR16 = _mm256_set1_epi16(0xF800);
+	const __m256i maskG16 = _mm256_set1_epi16(0x07E0);
+	const __m256i maskB16 = _mm256_set1_epi16(0x001F);
+
+	size_t x = 0;
+	for (; x + 31 < w; x += 32) {
+		__m256i pix0 = _load2(&in[x], &in[x + 16]);
+		__m256i pix1 = _load2(&in[x + 8], &in[x + 24]);
+
+		// Mask out channels and normalize them to 16-bit per channel
+		__m256i r0 = _mm256_srli_epi16(_mm256_and_si256(pix0, maskR16), 8);
+		__m256i g0 = _mm256_srli_epi16(_mm256_and_si256(pix0, maskG16), 3);
+		__m256i b0 = _mm256_slli_epi16(_mm256_and_si256(pix0, maskB16), 3);
+		__m256i r1 = _mm256_srli_epi16(_mm256_and_si256(pix1, maskR16), 8);
+		__m256i g1 = _mm256_srli_epi16(_mm256_and_si256(pix1, maskG16), 3);
+		__m256i b1 = _mm256_slli_epi16(_mm256_and_si256(pix1, maskB16), 3);
+
+		// Halve channel width and mix to discrete bytes
+		__m256i out0 = _mm256_shuffle_epi8(r0, rblend00);
+		out0 = _mm256_or_si256(out0, _mm256_shuffle_epi8(g0, gblend00));
+		out0 = _mm256_or_si256(out0, _mm256_shuffle_epi8(b0, bblend00));
+
+		__m256i out1 = _mm256_shuffle_epi8(r0, rblend10);
+		out1 = _mm256_or_si256(out1, _mm256_shuffle_epi8(g0, gblend10));
+		out1 = _mm256_or_si256(out1, _mm256_shuffle_epi8(b0, bblend10));
+		out1 = _mm256_or_si256(out1, _mm256_shuffle_epi8(r1, rblend11));
+		out1 = _mm256_or_si256(out1, _mm256_shuffle_epi8(g1, gblend11));
+		out1 = _mm256_or_si256(out1, _mm256_shuffle_epi8(b1, bblend11));
+
+		__m256i out2 = _mm256_shuffle_epi8(r1, rblend21);
+		out2 = _mm256_or_si256(out2, _mm256_shuffle_epi8(g1, gblend21));
+		out2 = _mm256_or_si256(out2, _mm256_shuffle_epi8(b1, bblend21));
+
+		_store888(out, out0, out1, out2);
+		out += 32 * 3;
+	}
+	return x;
+}
+
+size_t Retro::imageHalveX888ToGrayAVX2(const uint32_t* in, uint8_t* out, size_t w, size_t stride) {
+	size_t x = 0;
+	for (; x + 15 < w; x += 16) {
+		__m256i gray0;
+		__m256i gray1;
+
+		gray0 = _convertX888ToGray(_load2(&in[x], &in[x + 8]));
+		gray1 = _convertX888ToGray(_load2(&in[x + 4], &in[x + 12]));
+		__m256i out0 = _halveW32(gray0, gray1);
+
+		gray0 = _convertX888ToGray(_load2(&in[x + stride / 2], &in[x + 8 + stride / 2]));
+		gray1 = _convertX888ToGray(_load2(&in[x + 4 + stride / 2], &in[x + 12 + stride / 2]));
+		__m256i out1 = _halveW32(gray0, gray1);
+
+		// Halve height
+		_store8(out, _mm256_avg_epu16(out0, out1));
+		out += 8;
+	}
+	return x;
+}
+
+size_t Retro::imageQuarterX888ToGrayAVX2(const uint32_t* in, uint8_t* out, size_t w, size_t stride) {
+	size_t x = 0;
+	for (; x + 31 < w; x += 32) {
+		__m256i gray0;
+		__m256i gray1;
+
+		gray0 = _halveWNeighbor32(_load2(&in[x], &in[x + 16]), _load2(&in[x + 4], &in[x + 20]));
+		gray1 = _halveWNeighbor32(_load2(&in[x + 8], &in[x + 24]), _load2(&in[x + 12], &in[x + 28]));
+		__m256i out0 = _halveW32(_convertX888ToGray(gray0), _convertX888ToGray(gray1));
+
+		gray0 = _halveWNeighbor32(_load2(&in[x + stride / 2], &in[x + 16 + stride / 2]), _load2(&in[x + 4 + stride / 2], &in[x + 20 + stride / 2]));
+		gray1 = _halveWNeighbor32(_load2(&in[x + 8 + stride / 2], &in[x + 24 + stride / 2]), _load2(&in[x + 12 + stride / 2], &in[x + 28 + stride / 2]));
+		__m256i out1 = _halveW32(_convertX888ToGray(gray0), _convertX888ToGray(gray1));
+
+		// Halve height
+		_store8(out, _mm256_avg_epu16(out0, out1));
+		out += 8;
+	}
+	return x;
+}
+
+size_t Retro::imageX888To888AVX2(const uint32_t* in, uint8_t* out, size_t w) {
+	/* See imageX888To888 in imageops.cpp for the layout of each mask */
+	const __m256i blend00 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x80, 0x0C, 0x0D, 0x0E, 0x08, 0x09, 0x0A, 0x04, 0x05, 0x06, 0x00, 0x01, 0x02));
+	const __m256i blend01 = _broadcast(_mm_set_epi8(0x06, 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80));
+	const __m256i blend11 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0C, 0x0D, 0x0E, 0x08, 0x09, 0x0A, 0x04, 0x05));
+	const __m256i blend12 = _broadcast(_mm_set_epi8(0x09, 0x0A, 0x04, 0x05, 0x06, 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80));
+	const __m256i blend22 = _broadcast(_mm_set_epi8(0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0C, 0x0D, 0x0E, 0x08));
+	const __m256i blend23 = _broadcast(_mm_set_epi8(0x0C, 0x0D, 0x0E, 0x08, 0x09, 0x0A, 0x04, 0x05, 0x06, 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x80));
+
+	size_t x = 0;
+	for (; x + 31 < w; x += 32) {
+		__m256i pix0 = _load2(&in[x], &in[x + 16]);
+		__m256i pix1 = _load2(&in[x + 4], &in[x + 20]);
+		__m256i pix2 = _load2(&in[x + 8], &in[x + 24]);
+		__m256i pix3 = _load2(&in[x + 12], &in[x + 28]);
+
+		__m256i out0 = _mm256_shuffle_epi8(pix0, blend00);
+		out0 = _mm256_or_si256(out0, _mm256_shuffle_epi8(pix1, blend01));
+
+		__m256i out1 = _mm256_shuffle_epi8(pix1, blend11);
+		out1 = _mm256_or_si256(out1, _mm256_shuffle_epi8(pix2, blend12));
+
+		__m256i out2 = _mm256_shuffle_epi8(pix2, blend22);
+		out2 = _mm256_or_si256(out2, _mm256_shuffle_epi8(pix3, blend23));
+
+		_store888(out, out0, out1, out2);
+		out += 32 * 3;
+	}
+	return x;
+}
+
+/* Gray with the same weighting as _resizeGray in imageops.cpp */
+static inline __m256i _resizeGray(__m256i r, __m256i g, __m256i b) {
+	__m256i gray = _mm256_add_epi16(r, g);
+	gray = _mm256_add_epi16(gray, b);
+	return _mm256_srli_epi16(gray, 2);
+}
+
+static inline void _resizeChannels565(__m256i pix, __m256i* r, __m256i* g, __m256i* b) {
+	*r = _mm256_srli_epi16(_mm256_and_si256(pix, _mm256_set1_epi16(0xF800)), 8);
+	*g = _mm256_srli_epi16(_mm256_and_si256(pix, _mm256_set1_epi16(0x07E0)), 3);
+	*b = _mm256_slli_epi16(_mm256_and_si256(pix, _mm256_set1_epi16(0x001F)), 3);
+}
+
+static inline void _resizeChannelsX888(__m256i pix0, __m256i pix1, __m256i* r, __m256i* g, __m256i* b) {
+	const __m256i mask = _mm256_set1_epi32(0xFF);
+	*r = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(pix0, 16), mask), _mm256_and_si256(_mm256_srli_epi32(pix1, 16), mask));
+	*g = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(pix0, 8), mask), _mm256_and_si256(_mm256_srli_epi32(pix1, 8), mask));
+	*b = _mm256_packs_epi32(_mm256_and_si256(pix0, mask), _mm256_and_si256(pix1, mask));
+}
+
+/* Store the unpacked channels of 32 pixels as a gray plane, or R, G and B planes */
+static inline void _storeResizePlanes(uint8_t* out, size_t w, bool gray, __m256i r0, __m256i g0, __m256i b0, __m256i r1, __m256i g1, __m256i b1) {
+	if (gray) {
+		__m256i out0 = _mm256_packus_epi16(_resizeGray(r0, g0, b0), _resizeGray(r1, g1, b1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), out0);
+	} else {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_packus_epi16(r0, r1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[w]), _mm256_packus_epi16(g0, g1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[w * 2]), _mm256_packus_epi16(b0, b1));
+	}
+}
+
+size_t Retro::imageResizeUnpack565AVX2(const uint16_t* in, uint8_t* out, size_t w, bool gray) {
+	size_t x = 0;
+	for (; x + 31 < w; x += 32) {
+		__m256i r0, g0, b0;
+		__m256i r1, g1, b1;
+		_resizeChannels565(_load2(&in[x], &in[x + 16]), &r0, &g0, &b0);
+		_resizeChannels565(_load2(&in[x + 8], &in[x + 24]), &r1, &g1, &b1);
+		_storeResizePlanes(&out[x], w, gray, r0, g0, b0, r1, g1, b1);
+	}
+	return x;
+}
+
+size_t Retro::imageResizeUnpackX888AVX2(const uint32_t* in, uint8_t* out, size_t w, bool gray) {
+	size_t x = 0;
+	for (; x + 31 < w; x += 32) {
+		__m256i r0, g0, b0;
+		__m256i r1, g1, b1;
+		_resizeChannelsX888(_load2(&in[x], &in[x + 16]), _load2(&in[x + 4], &in[x + 20]), &r0, &g0, &b0);
+		_resizeChannelsX888(_load2(&in[x + 8], &in[x + 24]), _load2(&in[x + 12], &in[x + 28]), &r1, &g1, &b1);
+		_storeResizePlanes(&out[x], w, gray, r0, g0, b0, r1, g1, b1);
+	}
+	return x;
+}
+
+size_t Retro::imageResizeColumnAVX2(const uint8_t* const* in, const uint16_t* weights, size_t taps, uint16_t* out, size_t w) {
+	const __m256i zero = _mm256_setzero_si256();
+	size_t x = 0;
+	for (; x + 31 < w; x += 32) {
+		__m256i sum0 = _mm256_setzero_si256();
+		__m256i sum1 = _mm256_setzero_si256();
+		for (size_t t = 0; t < taps; ++t) {
+			__m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[t][x]));
+			__m256i weight = _mm256_set1_epi16(weights[t]);
+			sum0 = _mm256_add_epi16(sum0, _mm256_mullo_epi16(_mm256_unpacklo_epi8(row, zero), weight));
+			sum1 = _mm256_add_epi16(sum1, _mm256_mullo_epi16(_mm256_unpackhi_epi8(row, zero), weight));
+		}
+		// Unpacking works within lanes, so put the halves back in pixel order
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[x]), _mm256_permute2x128_si256(sum0, sum1, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[x + 16]), _mm256_permute2x128_si256(sum0, sum1, 0x31));
+	}
+	return x;
+}
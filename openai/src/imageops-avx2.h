@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* AVX2 versions of the imageops kernels. Only imageops-avx2.cpp is compiled
+ * with AVX2 enabled, so these must only be called when the CPU supports it.
+ *
+ * Each converts the start of one output row and returns the number of input
+ * pixels consumed, leaving the rest of the row to the SSSE3 and scalar loops.
+ */
+namespace Retro {
+
+size_t imageHalve565ToGrayAVX2(const uint16_t* in, uint8_t* out, size_t w, size_t stride);
+size_t imageQuarter565ToGrayAVX2(const uint16_t* in, uint8_t* out, size_t w, size_t stride);
+size_t image565To888AVX2(const uint16_t* in, uint8_t* out, size_t w);
+size_t imageHalveX888ToGrayAVX2(const uint32_t* in, uint8_t* out, size_t w, size_t stride);
+size_t imageQuarterX888ToGrayAVX2(const uint32_t* in, uint8_t* out, size_t w, size_t stride);
+size_t imageX888To888AVX2(const uint32_t* in, uint8_t* out, size_t w);
+
+/* Resize helpers. The unpackers split a source row into a gray plane, or R, G
+ * and B planes `w` bytes apart. The column blend returns the number of pixels
+ * blended.
+ */
+size_t imageResizeUnpack565AVX2(const uint16_t* in, uint8_t* out, size_t w, bool gray);
+size_t imageResizeUnpackX888AVX2(const uint32_t* in, uint8_t* out, size_t w, bool gray);
+size_t imageResizeColumnAVX2(const uint8_t* const* in, const uint16_t* weights, size_t taps, uint16_t* out, size_t w);
+}
@@ -1,11 +1,22 @@
 #include "imageops.h"
+#include "perf.h"
+#ifdef RETRO_IMAGEOPS_AVX2
+#include "imageops-avx2.h"
+#endif
 
 #ifdef __SSSE3__
 #include <emmintrin.h>
 #include <tmmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
 #endif
-#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
+#include <list>
+#include <stdexcept>
+#include <vector>
 
 using namespace Retro;
 using namespace std;
@@ -20,6 +31,27 @@ static void imageHalveX888ToGrayInterlace(const uint32_t* in, const uint16_t* ol
 static void imageQuarterX888ToGray(const uint32_t* in, uint8_t* out, size_t w, size_t h, size_t stride);
 static void imageQuarterX888ToGrayInterlace(const uint32_t* in, const uint16_t* oldin, uint16_t* out, size_t w, size_t h, size_t stride);
 static void imageX888To888(const uint32_t* in, uint8_t* out, size_t w, size_t h, size_t stride);
+static void imageResize(Image::Format format, const uint8_t* in, size_t stride, size_t x, size_t y, size_t w, size_t h, uint8_t* out, size_t outW, size_t outH, size_t outStride, bool gray, Image::Filter filter);
+
+#ifdef RETRO_IMAGEOPS_AVX2
+/* The AVX2 kernels are built separately and picked at runtime, so that builds
+ * stay portable to CPUs without AVX2. Setting RETRO_DISABLE_AVX2 in the
+ * environment forces the SSSE3 kernels, e.g. for comparing the two.
+ */
+static bool cpuHasAVX2() {
+	if (getenv("RETRO_DISABLE_AVX2")) {
+		return false;
+	}
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+static const bool useAVX2 = cpuHasAVX2();
+#endif
 
 #ifdef __SSSE3__
 const static __m128i maskR16 = _mm_set1_epi16(0xF800);
@@ -43,6 +75,26 @@ static inline __m128i _convert565ToGray(__m128i pix) {
 	r = _mm_add_epi16(r, b);
 	return r;
 }
+#elif defined(__wasm_simd128__)
+const static v128_t maskR16 = wasm_u16x8_splat(0xF800);
+const static v128_t maskG16 = wasm_u16x8_splat(0x07E0);
+const static v128_t maskB16 = wasm_u16x8_splat(0x001F);
+const static v128_t maskC32 = wasm_u32x4_splat(0x000000FF);
+
+static inline v128_t _convert565ToGray(v128_t pix) {
+	/* Mask out channels */
+	v128_t r = wasm_v128_and(pix, maskR16);
+	v128_t g = wasm_v128_and(pix, maskG16);
+	v128_t b = wasm_v128_and(pix, maskB16);
+	/* Normalize channels */
+	r = wasm_u16x8_shr(r, 10);
+	g = wasm_u16x8_shr(g, 5);
+	b = wasm_i16x8_shl(b, 1);
+	/* Combine channels */
+	r = wasm_i16x8_add(r, g);
+	r = wasm_i16x8_add(r, b);
+	return r;
+}
 #endif
 
 static inline uint8_t _convert565ToGray(uint16_t a, uint16_t b) {
@@ -70,6 +122,18 @@ static inline __m128i _convertX888ToGray(__m128i pix) {
 	r = _mm_srli_epi16(r, 2);
 	return r;
 }
+#elif defined(__wasm_simd128__)
+static inline v128_t _convertX888ToGray(v128_t pix) {
+	/* Mask out channels */
+	v128_t r = wasm_v128_and(wasm_u32x4_shr(pix, 16), maskC32);
+	v128_t g = wasm_v128_and(wasm_u32x4_shr(pix, 8), maskC32);
+	v128_t b = wasm_v128_and(pix, maskC32);
+	/* Combine channels */
+	r = wasm_i32x4_add(r, g);
+	r = wasm_i32x4_add(r, b);
+	r = wasm_u16x8_shr(r, 2);
+	return r;
+}
 #endif
 
 static inline uint8_t _convertX888ToGray(uint32_t a, uint32_t b) {
@@ -134,12 +198,44 @@ static inline __m128i _halveWNeighbor32(__m128i a, __m128i b) {
 	__m128i tmp1 = _mm_shuffle_epi32(b, 0xD8); /* EFGH -> EGFH */
 	return _mm_unpacklo_epi64(tmp0, tmp1); /* ACBD EGFH -> ACEG */
 }
+#elif defined(__wasm_simd128__)
+static inline v128_t _halveW16(v128_t a, v128_t b) {
+	/* Swizzle ABCDEFGH IJKLMNOP to ACEGIKMO BDFHJLNP */
+	v128_t tmp0 = wasm_i16x8_shuffle(a, b, 0, 2, 4, 6, 8, 10, 12, 14);
+	v128_t tmp1 = wasm_i16x8_shuffle(a, b, 1, 3, 5, 7, 9, 11, 13, 15);
+	/* Halve width */
+	return wasm_u16x8_avgr(tmp0, tmp1);
+}
+
+static inline v128_t _halveWNeighbor16(v128_t a, v128_t b) {
+	/* Swizzle ABCDEFGH IJKLMNOP to ACEGIKMO */
+	return wasm_i16x8_shuffle(a, b, 0, 2, 4, 6, 8, 10, 12, 14);
+}
+
+static inline v128_t _halveW32(v128_t a, v128_t b) {
+	/* Swizzle ABCD EFGH to ACEG BDFH */
+	v128_t tmp0 = wasm_i32x4_shuffle(a, b, 0, 2, 4, 6);
+	v128_t tmp1 = wasm_i32x4_shuffle(a, b, 1, 3, 5, 7);
+	/* Halve width */
+	return wasm_u16x8_avgr(tmp0, tmp1);
+}
+
+static inline v128_t _halveWNeighbor32(v128_t a, v128_t b) {
+	/* Swizzle ABCD EFGH to ACEG */
+	return wasm_i32x4_shuffle(a, b, 0, 2, 4, 6);
+}
 #endif
 
 void imageHalve565ToGray(const uint16_t* in, uint8_t* out, size_t w, size_t h, size_t stride) {
 	for (size_t y = 0; y + 1 < h; y += 2) {
 		size_t x = 0;
 #ifdef __SSSE3__
+#ifdef RETRO_IMAGEOPS_AVX2
+		if (useAVX2) {
+			x = imageHalve565ToGrayAVX2(in, out, w, stride);
+			out += x / 2;
+		}
+#endif
 		for (; x + 15 < w; x += 16) {
 			__m128i gray0;
 			__m128i gray1;
@@ -158,6 +254,25 @@ void imageHalve565ToGray(const uint16_t* in, uint8_t* out, size_t w, size_t h, s
 			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), out0);
 			out += 8;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 15 < w; x += 16) {
+			v128_t gray0;
+			v128_t gray1;
+
+			gray0 = _convert565ToGray(wasm_v128_load(&in[x]));
+			gray1 = _convert565ToGray(wasm_v128_load(&in[x + 8]));
+			v128_t out0 = _halveW16(gray0, gray1);
+
+			gray0 = _convert565ToGray(wasm_v128_load(&in[x + stride / 2]));
+			gray1 = _convert565ToGray(wasm_v128_load(&in[x + 8 + stride / 2]));
+			v128_t out1 = _halveW16(gray0, gray1);
+
+			// Halve height
+			out0 = wasm_u16x8_avgr(out0, out1);
+			out0 = wasm_u8x16_narrow_i16x8(out0, out0);
+			wasm_v128_store64_lane(out, out0, 0);
+			out += 8;
+		}
 #endif
 		for (; x < w; x += 2) {
 			unsigned gray0 = _convert565ToGray(in[x], in[x + 1]);
@@ -196,6 +311,30 @@ void imageHalve565ToGrayInterlace(const uint16_t* in, const uint16_t* oldin, uin
 			oldin += 8;
 			out += 8;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 15 < w; x += 16) {
+			v128_t gray0;
+			v128_t gray1;
+
+			gray0 = _convert565ToGray(wasm_v128_load(&in[x]));
+			gray1 = _convert565ToGray(wasm_v128_load(&in[x + 8]));
+			v128_t out0 = _halveW16(gray0, gray1);
+
+			gray0 = _convert565ToGray(wasm_v128_load(&in[x + stride / 2]));
+			gray1 = _convert565ToGray(wasm_v128_load(&in[x + 8 + stride / 2]));
+			v128_t out1 = _halveW16(gray0, gray1);
+
+			// Halve height
+			out0 = wasm_u16x8_avgr(out0, out1);
+
+			// Interlace with old data
+			out1 = wasm_v128_load(oldin);
+			out1 = wasm_i16x8_shl(out1, 8);
+			out0 = wasm_i8x16_add(out0, out1);
+			wasm_v128_store(out, out0);
+			oldin += 8;
+			out += 8;
+		}
 #endif
 		for (; x < w; x += 2) {
 			unsigned gray0 = _convert565ToGray(in[x], in[x + 1]);
@@ -214,6 +353,12 @@ void imageQuarter565ToGray(const uint16_t* in, uint8_t* out, size_t w, size_t h,
 	for (size_t y = 0; y + 3 < h; y += 4) {
 		size_t x = 0;
 #ifdef __SSSE3__
+#ifdef RETRO_IMAGEOPS_AVX2
+		if (useAVX2) {
+			x = imageQuarter565ToGrayAVX2(in, out, w, stride);
+			out += x / 4;
+		}
+#endif
 		for (; x + 31 < w; x += 32) {
 			__m128i gray0;
 			__m128i gray1;
@@ -236,6 +381,29 @@ void imageQuarter565ToGray(const uint16_t* in, uint8_t* out, size_t w, size_t h,
 			_mm_storel_epi64(reinterpret_cast<__m128i*>(out), out0);
 			out += 8;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 31 < w; x += 32) {
+			v128_t gray0;
+			v128_t gray1;
+
+			gray0 = _halveWNeighbor16(wasm_v128_load(&in[x]), wasm_v128_load(&in[x + 8]));
+			gray1 = _halveWNeighbor16(wasm_v128_load(&in[x + 16]), wasm_v128_load(&in[x + 24]));
+			gray0 = _convert565ToGray(gray0);
+			gray1 = _convert565ToGray(gray1);
+			v128_t out0 = _halveW16(gray0, gray1);
+
+			gray0 = _halveWNeighbor16(wasm_v128_load(&in[x + stride]), wasm_v128_load(&in[x + 8 + stride]));
+			gray1 = _halveWNeighbor16(wasm_v128_load(&in[x + 16 + stride]), wasm_v128_load(&in[x + 24 + stride]));
+			gray0 = _convert565ToGray(gray0);
+			gray1 = _convert565ToGray(gray1);
+			v128_t out1 = _halveW16(gray0, gray1);
+
+			// Halve height
+			out0 = wasm_u16x8_avgr(out0, out1);
+			out0 = wasm_u8x16_narrow_i16x8(out0, out0);
+			wasm_v128_store64_lane(out, out0, 0);
+			out += 8;
+		}
 #endif
 		for (; x + 3 < w; x += 4) {
 			unsigned gray0 = _convert565ToGray(in[x], in[x + 2]);
@@ -278,6 +446,34 @@ void imageQuarter565ToGrayInterlace(const uint16_t* in, const uint16_t* oldin, u
 			oldin += 8;
 			out += 8;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 31 < w; x += 32) {
+			v128_t gray0;
+			v128_t gray1;
+
+			gray0 = _halveWNeighbor16(wasm_v128_load(&in[x]), wasm_v128_load(&in[x + 8]));
+			gray1 = _halveWNeighbor16(wasm_v128_load(&in[x + 16]), wasm_v128_load(&in[x + 24]));
+			gray0 = _convert565ToGray(gray0);
+			gray1 = _convert565ToGray(gray1);
+			v128_t out0 = _halveW16(gray0, gray1);
+
+			gray0 = _halveWNeighbor16(wasm_v128_load(&in[x + stride]), wasm_v128_load(&in[x + 8 + stride]));
+			gray1 = _halveWNeighbor16(wasm_v128_load(&in[x + 16 + stride]), wasm_v128_load(&in[x + 24 + stride]));
+			gray0 = _convert565ToGray(gray0);
+			gray1 = _convert565ToGray(gray1);
+			v128_t out1 = _halveW16(gray0, gray1);
+
+			// Halve height
+			out0 = wasm_u16x8_avgr(out0, out1);
+
+			// Interlace with old data
+			out1 = wasm_v128_load(oldin);
+			out1 = wasm_i16x8_shl(out1, 8);
+			out0 = wasm_i8x16_add(out0, out1);
+			wasm_v128_store(out, out0);
+			oldin += 8;
+			out += 8;
+		}
 #endif
 		for (; x + 3 < w; x += 4) {
 			unsigned gray0 = _convert565ToGray(in[x], in[x + 2]);
@@ -369,16 +565,61 @@ static inline void _convert565To888(const __m128i* in, __m128i* out) {
 	_mm_store_si128(&out[1], out1);
 	_mm_store_si128(&out[2], out2);
 }
+#elif defined(__wasm_simd128__)
+static inline void _convert565To888(const uint16_t* in, uint8_t* out) {
+	v128_t pix0 = wasm_v128_load(&in[0]);
+	v128_t pix1 = wasm_v128_load(&in[8]);
+
+	// Mask out channels and normalize them to 8 bits per channel
+	v128_t r0 = wasm_u16x8_shr(wasm_v128_and(pix0, maskR16), 8);
+	v128_t g0 = wasm_u16x8_shr(wasm_v128_and(pix0, maskG16), 3);
+	v128_t b0 = wasm_i16x8_shl(wasm_v128_and(pix0, maskB16), 3);
+	v128_t r1 = wasm_u16x8_shr(wasm_v128_and(pix1, maskR16), 8);
+	v128_t g1 = wasm_u16x8_shr(wasm_v128_and(pix1, maskG16), 3);
+	v128_t b1 = wasm_i16x8_shl(wasm_v128_and(pix1, maskB16), 3);
+
+	// Halve channel width, leaving one 16 byte plane per channel
+	v128_t r = wasm_u8x16_narrow_i16x8(r0, r1);
+	v128_t g = wasm_u8x16_narrow_i16x8(g0, g1);
+	v128_t b = wasm_u8x16_narrow_i16x8(b0, b1);
+
+	/* R0 .. RF G0 .. GF -> R0 G0 xx R1 G1 xx R2 G2 xx R3 G3 xx R4 G4 xx R5, then fill in B0 .. B4 */
+	v128_t out0 = wasm_i8x16_shuffle(r, g, 0, 16, 0, 1, 17, 0, 2, 18, 0, 3, 19, 0, 4, 20, 0, 5);
+	out0 = wasm_i8x16_shuffle(out0, b, 0, 1, 16, 3, 4, 17, 6, 7, 18, 9, 10, 19, 12, 13, 20, 15);
+
+	/* R0 .. RF G0 .. GF -> G5 xx R6 G6 xx R7 G7 xx R8 G8 xx R9 G9 xx RA GA, then fill in B5 .. B9 */
+	v128_t out1 = wasm_i8x16_shuffle(r, g, 21, 0, 6, 22, 0, 7, 23, 0, 8, 24, 0, 9, 25, 0, 10, 26);
+	out1 = wasm_i8x16_shuffle(out1, b, 0, 21, 2, 3, 22, 5, 6, 23, 8, 9, 24, 11, 12, 25, 14, 15);
+
+	/* R0 .. RF G0 .. GF -> xx RB GB xx RC GC xx RD GD xx RE GE xx RF GF xx, then fill in BA .. BF */
+	v128_t out2 = wasm_i8x16_shuffle(r, g, 0, 11, 27, 0, 12, 28, 0, 13, 29, 0, 14, 30, 0, 15, 31, 0);
+	out2 = wasm_i8x16_shuffle(out2, b, 26, 1, 2, 27, 4, 5, 28, 7, 8, 29, 10, 11, 30, 13, 14, 31);
+
+	wasm_v128_store(&out[0], out0);
+	wasm_v128_store(&out[16], out1);
+	wasm_v128_store(&out[32], out2);
+}
 #endif
 
 void image565To888(const uint16_t* in, uint8_t* out, size_t w, size_t h, size_t stride) {
 	for (size_t y = 0; y < h; ++y) {
 		size_t x = 0;
 #ifdef __SSSE3__
+#ifdef RETRO_IMAGEOPS_AVX2
+		if (useAVX2) {
+			x = image565To888AVX2(in, out, w);
+			out += x * 3;
+		}
+#endif
 		for (; x < w; x += 16) {
 			_convert565To888(reinterpret_cast<const __m128i*>(&in[x]), reinterpret_cast<__m128i*>(out));
 			out += 16 * 3;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 15 < w; x += 16) {
+			_convert565To888(&in[x], out);
+			out += 16 * 3;
+		}
 #endif
 		for (; x < w; ++x) {
 			uint16_t rgb = in[x];
@@ -395,6 +636,12 @@ void imageHalveX888ToGray(const uint32_t* in, uint8_t* out, size_t w, size_t h,
 	for (size_t y = 0; y + 1 < h; y += 2) {
 		size_t x = 0;
 #ifdef __SSSE3__
+#ifdef RETRO_IMAGEOPS_AVX2
+		if (useAVX2) {
+			x = imageHalveX888ToGrayAVX2(in, out, w, stride);
+			out += x / 2;
+		}
+#endif
 		for (; x + 7 < w; x += 8) {
 			__m128i gray0;
 			__m128i gray1;
@@ -415,6 +662,26 @@ void imageHalveX888ToGray(const uint32_t* in, uint8_t* out, size_t w, size_t h,
 			*reinterpret_cast<uint32_t*>(out) = outx;
 			out += 4;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 7 < w; x += 8) {
+			v128_t gray0;
+			v128_t gray1;
+
+			gray0 = _convertX888ToGray(wasm_v128_load(&in[x]));
+			gray1 = _convertX888ToGray(wasm_v128_load(&in[x + 4]));
+			v128_t out0 = _halveW32(gray0, gray1);
+
+			gray0 = _convertX888ToGray(wasm_v128_load(&in[x + stride / 2]));
+			gray1 = _convertX888ToGray(wasm_v128_load(&in[x + 4 + stride / 2]));
+			v128_t out1 = _halveW32(gray0, gray1);
+
+			// Halve height
+			out0 = wasm_u16x8_avgr(out0, out1);
+			out0 = wasm_u8x16_narrow_i16x8(out0, out0);
+			out0 = wasm_u8x16_narrow_i16x8(out0, out0);
+			wasm_v128_store32_lane(out, out0, 0);
+			out += 4;
+		}
 #endif
 		for (; x + 1 < w; x += 2) {
 			*out = _convertX888ToGray(in[x], in[x + 1]);
@@ -452,6 +719,31 @@ void imageHalveX888ToGrayInterlace(const uint32_t* in, const uint16_t* oldin, ui
 			oldin += 4;
 			out += 4;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 7 < w; x += 8) {
+			v128_t gray0;
+			v128_t gray1;
+
+			gray0 = _convertX888ToGray(wasm_v128_load(&in[x]));
+			gray1 = _convertX888ToGray(wasm_v128_load(&in[x + 4]));
+			v128_t out0 = _halveW32(gray0, gray1);
+
+			gray0 = _convertX888ToGray(wasm_v128_load(&in[x + stride / 2]));
+			gray1 = _convertX888ToGray(wasm_v128_load(&in[x + 4 + stride / 2]));
+			v128_t out1 = _halveW32(gray0, gray1);
+
+			// Halve height
+			out0 = wasm_u16x8_avgr(out0, out1);
+			out0 = wasm_u8x16_narrow_i16x8(out0, out0);
+
+			// Interlace with old data
+			out1 = wasm_v128_load64_zero(oldin);
+			out1 = wasm_i16x8_shl(out1, 8);
+			out0 = wasm_i8x16_add(out0, out1);
+			wasm_v128_store64_lane(out, out0, 0);
+			oldin += 4;
+			out += 4;
+		}
 #endif
 		for (; x + 1 < w; x += 2) {
 			unsigned gray0 = _convertX888ToGray(in[x], in[x + 1]);
@@ -468,6 +760,12 @@ void imageQuarterX888ToGray(const uint32_t* in, uint8_t* out, size_t w, size_t h
 	for (size_t y = 0; y + 3 < h; y += 4) {
 		size_t x = 0;
 #ifdef __SSSE3__
+#ifdef RETRO_IMAGEOPS_AVX2
+		if (useAVX2) {
+			x = imageQuarterX888ToGrayAVX2(in, out, w, stride);
+			out += x / 4;
+		}
+#endif
 		for (; x + 15 < w; x += 16) {
 			__m128i gray0;
 			__m128i gray1;
@@ -492,6 +790,30 @@ void imageQuarterX888ToGray(const uint32_t* in, uint8_t* out, size_t w, size_t h
 			*reinterpret_cast<uint32_t*>(out) = outx;
 			out += 4;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 15 < w; x += 16) {
+			v128_t gray0;
+			v128_t gray1;
+
+			gray0 = _halveWNeighbor32(wasm_v128_load(&in[x]), wasm_v128_load(&in[x + 4]));
+			gray1 = _halveWNeighbor32(wasm_v128_load(&in[x + 8]), wasm_v128_load(&in[x + 12]));
+			gray0 = _convertX888ToGray(gray0);
+			gray1 = _convertX888ToGray(gray1);
+			v128_t out0 = _halveW32(gray0, gray1);
+
+			gray0 = _halveWNeighbor32(wasm_v128_load(&in[x + stride / 2]), wasm_v128_load(&in[x + 4 + stride / 2]));
+			gray1 = _halveWNeighbor32(wasm_v128_load(&in[x + 8 + stride / 2]), wasm_v128_load(&in[x + 12 + stride / 2]));
+			gray0 = _convertX888ToGray(gray0);
+			gray1 = _convertX888ToGray(gray1);
+			v128_t out1 = _halveW32(gray0, gray1);
+
+			// Halve height
+			out0 = wasm_u16x8_avgr(out0, out1);
+			out0 = wasm_u8x16_narrow_i16x8(out0, out0);
+			out0 = wasm_u8x16_narrow_i16x8(out0, out0);
+			wasm_v128_store32_lane(out, out0, 0);
+			out += 4;
+		}
 #endif
 		for (; x + 3 < w; x += 4) {
 			unsigned gray0 = _convertX888ToGray(in[x], in[x + 2]);
@@ -535,6 +857,35 @@ void imageQuarterX888ToGrayInterlace(const uint32_t* in, const uint16_t* oldin,
 			oldin += 4;
 			out += 4;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 15 < w; x += 16) {
+			v128_t gray0;
+			v128_t gray1;
+
+			gray0 = _halveWNeighbor32(wasm_v128_load(&in[x]), wasm_v128_load(&in[x + 4]));
+			gray1 = _halveWNeighbor32(wasm_v128_load(&in[x + 8]), wasm_v128_load(&in[x + 12]));
+			gray0 = _convertX888ToGray(gray0);
+			gray1 = _convertX888ToGray(gray1);
+			v128_t out0 = _halveW32(gray0, gray1);
+
+			gray0 = _halveWNeighbor32(wasm_v128_load(&in[x + stride / 2]), wasm_v128_load(&in[x + 4 + stride / 2]));
+			gray1 = _halveWNeighbor32(wasm_v128_load(&in[x + 8 + stride / 2]), wasm_v128_load(&in[x + 12 + stride / 2]));
+			gray0 = _convertX888ToGray(gray0);
+			gray1 = _convertX888ToGray(gray1);
+			v128_t out1 = _halveW32(gray0, gray1);
+
+			// Halve height
+			out0 = wasm_u16x8_avgr(out0, out1);
+			out0 = wasm_u8x16_narrow_i16x8(out0, out0);
+
+			// Interlace with old data
+			out1 = wasm_v128_load64_zero(oldin);
+			out1 = wasm_i16x8_shl(out1, 8);
+			out0 = wasm_i8x16_add(out0, out1);
+			wasm_v128_store64_lane(out, out0, 0);
+			oldin += 4;
+			out += 4;
+		}
 #endif
 		for (; x + 3 < w; x += 4) {
 			unsigned gray0 = _convertX888ToGray(in[x], in[x + 2]);
@@ -553,6 +904,12 @@ void imageX888To888(const uint32_t* in, uint8_t* out, size_t w, size_t h, size_t
 	for (size_t y = 0; y < h; ++y) {
 		size_t x = 0;
 #ifdef __SSSE3__
+#ifdef RETRO_IMAGEOPS_AVX2
+		if (useAVX2) {
+			x = imageX888To888AVX2(in, out, w);
+			out += x * 3;
+		}
+#endif
 		for (; x + 15 < w; x += 16) {
 			/* B0 G0 R0 X0 B1 G1 R1 X1 B2 G2 R2 X2 B3 G3 R3 X3 -> R0 G0 B0 R1 G1 B1 R2 G2 B2 R3 G3 B3 00 00 00 00 */
 			const static __m128i blend00 = _mm_set_epi8(0x80, 0x80, 0x80, 0x80, 0x0C, 0x0D, 0x0E, 0x08, 0x09, 0x0A, 0x04, 0x05, 0x06, 0x00, 0x01, 0x02);
@@ -591,6 +948,27 @@ void imageX888To888(const uint32_t* in, uint8_t* out, size_t w, size_t h, size_t
 			_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[32]), out2);
 			out += 48;
 		}
+#elif defined(__wasm_simd128__)
+		for (; x + 15 < w; x += 16) {
+			v128_t pix0 = wasm_v128_load(&in[x]);
+			v128_t pix1 = wasm_v128_load(&in[x + 4]);
+			v128_t pix2 = wasm_v128_load(&in[x + 8]);
+			v128_t pix3 = wasm_v128_load(&in[x + 12]);
+
+			/* B0 G0 R0 X0 .. B7 G7 R7 X7 -> R0 G0 B0 R1 G1 B1 R2 G2 B2 R3 G3 B3 R4 G4 B4 R5 */
+			v128_t out0 = wasm_i8x16_shuffle(pix0, pix1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, 18, 17, 16, 22);
+
+			/* B4 G4 R4 X4 .. BB GB RB XB -> G5 B5 R6 G6 B6 R7 G7 B7 R8 G8 B8 R9 G9 B9 RA GA */
+			v128_t out1 = wasm_i8x16_shuffle(pix1, pix2, 5, 4, 10, 9, 8, 14, 13, 12, 18, 17, 16, 22, 21, 20, 26, 25);
+
+			/* B8 G8 R8 X8 .. BF GF RF XF -> BA RB GB BB RC GC BC RD GD BD RE GE BE RF GF BF */
+			v128_t out2 = wasm_i8x16_shuffle(pix2, pix3, 8, 14, 13, 12, 18, 17, 16, 22, 21, 20, 26, 25, 24, 30, 29, 28);
+
+			wasm_v128_store(&out[0], out0);
+			wasm_v128_store(&out[16], out1);
+			wasm_v128_store(&out[32], out2);
+			out += 48;
+		}
 #endif
 		for (; x < w; ++x) {
 			uint32_t xrgb = in[x];
@@ -603,6 +981,348 @@ void imageX888To888(const uint32_t* in, uint8_t* out, size_t w, size_t h, size_t
 	}
 }
 
+/* Resizing is separable. Source rows are unpacked into 8-bit channel planes
+ * and blended vertically into 16-bit rows, which are then resampled
+ * horizontally. Weights are 8-bit fixed point, so vertical sums fit in 16 bits.
+ */
+static const unsigned RESIZE_SHIFT = 8;
+static const unsigned RESIZE_ONE = 1 << RESIZE_SHIFT;
+
+/* Every output index reads `taps` consecutive source indices from `start`,
+ * weighted by `weights`, which sum to RESIZE_ONE.
+ */
+struct ResizeTaps {
+	vector<size_t> start;
+	vector<uint16_t> weights;
+	size_t taps = 0;
+};
+
+static ResizeTaps resizeTaps(size_t in, size_t out, Image::Filter filter) {
+	double scale = static_cast<double>(in) / out;
+	vector<size_t> first(out);
+	vector<size_t> count(out);
+	vector<double> position(out);
+	ResizeTaps taps;
+	for (size_t i = 0; i < out; ++i) {
+		switch (filter) {
+		case Image::Filter::AREA:
+			// Every source pixel overlapping the output pixel's footprint
+			first[i] = static_cast<size_t>(i * scale);
+			count[i] = min(static_cast<size_t>(ceil((i + 1) * scale)), in) - first[i];
+			break;
+		case Image::Filter::BILINEAR:
+			// Sample at pixel centers, clamping at the edges
+			position[i] = min(max((i + 0.5) * scale - 0.5, 0.), in - 1.);
+			first[i] = static_cast<size_t>(position[i]);
+			count[i] = first[i] + 1 < in ? 2 : 1;
+			break;
+		}
+		taps.taps = max(taps.taps, count[i]);
+	}
+
+	taps.start.resize(out);
+	taps.weights.resize(out * taps.taps);
+	for (size_t i = 0; i < out; ++i) {
+		// Shift windows that would run off the end, padding with zero weights
+		size_t offset = 0;
+		if (first[i] + taps.taps > in) {
+			offset = first[i] + taps.taps - in;
+		}
+		taps.start[i] = first[i] - offset;
+
+		// Round the running total so that the weights sum exactly to RESIZE_ONE
+		uint16_t* weights = &taps.weights[i * taps.taps + offset];
+		double total = 0;
+		unsigned previous = 0;
+		for (size_t t = 0; t < count[i]; ++t) {
+			size_t j = first[i] + t;
+			switch (filter) {
+			case Image::Filter::AREA:
+				total += max(min((i + 1) * scale, j + 1.) - max(i * scale, static_cast<double>(j)), 0.) / scale;
+				break;
+			case Image::Filter::BILINEAR:
+				total += t ? position[i] - first[i] : 1 - (position[i] - first[i]);
+				break;
+			}
+			unsigned current = t + 1 < count[i] ? lround(total * RESIZE_ONE) : RESIZE_ONE;
+			weights[t] = current - previous;
+			previous = current;
+		}
+	}
+	return taps;
+}
+
+/* Observations resize between the same dimensions every step, so the most
+ * recently used tables are kept per thread rather than rebuilt on each call.
+ */
+static const ResizeTaps& cachedResizeTaps(size_t in, size_t out, Image::Filter filter) {
+	struct Entry {
+		size_t in;
+		size_t out;
+		Image::Filter filter;
+		ResizeTaps taps;
+	};
+	static const size_t CACHE_SIZE = 8;
+	// A list keeps references valid while other entries are added or moved
+	static thread_local list<Entry> cache;
+
+	for (auto entry = cache.begin(); entry != cache.end(); ++entry) {
+		if (entry->in == in && entry->out == out && entry->filter == filter) {
+			cache.splice(cache.begin(), cache, entry);
+			return cache.front().taps;
+		}
+	}
+
+	if (cache.size() == CACHE_SIZE) {
+		cache.pop_back();
+	}
+	cache.push_front(Entry{ in, out, filter, resizeTaps(in, out, filter) });
+	return cache.front().taps;
+}
+
+/* Same weighting as the other gray kernels, (R + G + B) / 4, so that resized
+ * and halved or quartered frames have the same intensities
+ */
+static inline uint8_t _resizeGray(unsigned r, unsigned g, unsigned b) {
+	return (r + g + b) >> 2;
+}
+
+#ifdef __SSSE3__
+static inline __m128i _resizeGray(__m128i r, __m128i g, __m128i b) {
+	__m128i gray = _mm_add_epi16(r, g);
+	gray = _mm_add_epi16(gray, b);
+	return _mm_srli_epi16(gray, 2);
+}
+
+static inline void _resizeChannels565(__m128i pix, __m128i* r, __m128i* g, __m128i* b) {
+	*r = _mm_srli_epi16(_mm_and_si128(pix, maskR16), 8);
+	*g = _mm_srli_epi16(_mm_and_si128(pix, maskG16), 3);
+	*b = _mm_slli_epi16(_mm_and_si128(pix, maskB16), 3);
+}
+
+static inline void _resizeChannelsX888(__m128i pix0, __m128i pix1, __m128i* r, __m128i* g, __m128i* b) {
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	*r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(pix0, 16), mask), _mm_and_si128(_mm_srli_epi32(pix1, 16), mask));
+	*g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(pix0, 8), mask), _mm_and_si128(_mm_srli_epi32(pix1, 8), mask));
+	*b = _mm_packs_epi32(_mm_and_si128(pix0, mask), _mm_and_si128(pix1, mask));
+}
+#elif defined(__wasm_simd128__)
+static inline v128_t _resizeGray(v128_t r, v128_t g, v128_t b) {
+	v128_t gray = wasm_i16x8_add(r, g);
+	gray = wasm_i16x8_add(gray, b);
+	return wasm_u16x8_shr(gray, 2);
+}
+
+static inline void _resizeChannels565(v128_t pix, v128_t* r, v128_t* g, v128_t* b) {
+	*r = wasm_u16x8_shr(wasm_v128_and(pix, maskR16), 8);
+	*g = wasm_u16x8_shr(wasm_v128_and(pix, maskG16), 3);
+	*b = wasm_i16x8_shl(wasm_v128_and(pix, maskB16), 3);
+}
+
+static inline void _resizeChannelsX888(v128_t pix0, v128_t pix1, v128_t* r, v128_t* g, v128_t* b) {
+	*r = wasm_i16x8_narrow_i32x4(wasm_v128_and(wasm_u32x4_shr(pix0, 16), maskC32), wasm_v128_and(wasm_u32x4_shr(pix1, 16), maskC32));
+	*g = wasm_i16x8_narrow_i32x4(wasm_v128_and(wasm_u32x4_shr(pix0, 8), maskC32), wasm_v128_and(wasm_u32x4_shr(pix1, 8), maskC32));
+	*b = wasm_i16x8_narrow_i32x4(wasm_v128_and(pix0, maskC32), wasm_v128_and(pix1, maskC32));
+}
+#endif
+
+/* Unpack `w` pixels of a source row into a gray plane, or R, G and B planes */
+static void resizeUnpackRow(Image::Format format, const uint8_t* in, size_t w, bool gray, uint8_t* out) {
+	size_t x = 0;
+#ifdef __SSSE3__
+#ifdef RETRO_IMAGEOPS_AVX2
+	if (useAVX2) {
+		if (format == Image::Format::RGB565) {
+			x = imageResizeUnpack565AVX2(reinterpret_cast<const uint16_t*>(in), out, w, gray);
+		} else {
+			x = imageResizeUnpackX888AVX2(reinterpret_cast<const uint32_t*>(in), out, w, gray);
+		}
+	}
+#endif
+	for (; x + 15 < w; x += 16) {
+		__m128i r0, g0, b0;
+		__m128i r1, g1, b1;
+		if (format == Image::Format::RGB565) {
+			const __m128i* pix = reinterpret_cast<const __m128i*>(&in[x * 2]);
+			_resizeChannels565(_mm_loadu_si128(&pix[0]), &r0, &g0, &b0);
+			_resizeChannels565(_mm_loadu_si128(&pix[1]), &r1, &g1, &b1);
+		} else {
+			const __m128i* pix = reinterpret_cast<const __m128i*>(&in[x * 4]);
+			_resizeChannelsX888(_mm_loadu_si128(&pix[0]), _mm_loadu_si128(&pix[1]), &r0, &g0, &b0);
+			_resizeChannelsX888(_mm_loadu_si128(&pix[2]), _mm_loadu_si128(&pix[3]), &r1, &g1, &b1);
+		}
+		if (gray) {
+			__m128i out0 = _mm_packus_epi16(_resizeGray(r0, g0, b0), _resizeGray(r1, g1, b1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x]), out0);
+		} else {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(r0, r1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x + w]), _mm_packus_epi16(g0, g1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x + w * 2]), _mm_packus_epi16(b0, b1));
+		}
+	}
+#elif defined(__wasm_simd128__)
+	for (; x + 15 < w; x += 16) {
+		v128_t r0, g0, b0;
+		v128_t r1, g1, b1;
+		if (format == Image::Format::RGB565) {
+			_resizeChannels565(wasm_v128_load(&in[x * 2]), &r0, &g0, &b0);
+			_resizeChannels565(wasm_v128_load(&in[x * 2 + 16]), &r1, &g1, &b1);
+		} else {
+			_resizeChannelsX888(wasm_v128_load(&in[x * 4]), wasm_v128_load(&in[x * 4 + 16]), &r0, &g0, &b0);
+			_resizeChannelsX888(wasm_v128_load(&in[x * 4 + 32]), wasm_v128_load(&in[x * 4 + 48]), &r1, &g1, &b1);
+		}
+		if (gray) {
+			wasm_v128_store(&out[x], wasm_u8x16_narrow_i16x8(_resizeGray(r0, g0, b0), _resizeGray(r1, g1, b1)));
+		} else {
+			wasm_v128_store(&out[x], wasm_u8x16_narrow_i16x8(r0, r1));
+			wasm_v128_store(&out[x + w], wasm_u8x16_narrow_i16x8(g0, g1));
+			wasm_v128_store(&out[x + w * 2], wasm_u8x16_narrow_i16x8(b0, b1));
+		}
+	}
+#endif
+	for (; x < w; ++x) {
+		unsigned r, g, b;
+		if (format == Image::Format::RGB565) {
+			uint16_t rgb = reinterpret_cast<const uint16_t*>(in)[x];
+			r = (rgb & 0xF800) >> 8;
+			g = (rgb & 0x07E0) >> 3;
+			b = (rgb & 0x001F) << 3;
+		} else {
+			uint32_t xrgb = reinterpret_cast<const uint32_t*>(in)[x];
+			r = (xrgb >> 16) & 0xFF;
+			g = (xrgb >> 8) & 0xFF;
+			b = xrgb & 0xFF;
+		}
+		if (gray) {
+			out[x] = _resizeGray(r, g, b);
+		} else {
+			out[x] = r;
+			out[x + w] = g;
+			out[x + w * 2] = b;
+		}
+	}
+}
+
+/* Blend unpacked rows vertically. The weights sum to RESIZE_ONE, so the
+ * result keeps RESIZE_SHIFT bits of fraction without overflowing.
+ */
+static void resizeColumn(const uint8_t* const* in, const uint16_t* weights, size_t taps, uint16_t* out, size_t w) {
+	size_t x = 0;
+#ifdef __SSSE3__
+#ifdef RETRO_IMAGEOPS_AVX2
+	if (useAVX2) {
+		x = imageResizeColumnAVX2(in, weights, taps, out, w);
+	}
+#endif
+	const __m128i zero = _mm_setzero_si128();
+	for (; x + 15 < w; x += 16) {
+		__m128i sum0 = _mm_setzero_si128();
+		__m128i sum1 = _mm_setzero_si128();
+		for (size_t t = 0; t < taps; ++t) {
+			__m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[t][x]));
+			__m128i weight = _mm_set1_epi16(weights[t]);
+			sum0 = _mm_add_epi16(sum0, _mm_mullo_epi16(_mm_unpacklo_epi8(row, zero), weight));
+			sum1 = _mm_add_epi16(sum1, _mm_mullo_epi16(_mm_unpackhi_epi8(row, zero), weight));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x]), sum0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x + 8]), sum1);
+	}
+#elif defined(__wasm_simd128__)
+	for (; x + 15 < w; x += 16) {
+		v128_t sum0 = wasm_i16x8_splat(0);
+		v128_t sum1 = wasm_i16x8_splat(0);
+		for (size_t t = 0; t < taps; ++t) {
+			v128_t row = wasm_v128_load(&in[t][x]);
+			v128_t weight = wasm_i16x8_splat(weights[t]);
+			sum0 = wasm_i16x8_add(sum0, wasm_i16x8_mul(wasm_u16x8_extend_low_u8x16(row), weight));
+			sum1 = wasm_i16x8_add(sum1, wasm_i16x8_mul(wasm_u16x8_extend_high_u8x16(row), weight));
+		}
+		wasm_v128_store(&out[x], sum0);
+		wasm_v128_store(&out[x + 8], sum1);
+	}
+#endif
+	for (; x < w; ++x) {
+		unsigned sum = 0;
+		for (size_t t = 0; t < taps; ++t) {
+			sum += in[t][x] * weights[t];
+		}
+		out[x] = sum;
+	}
+}
+
+/* Resample a blended row horizontally into every `step`th byte of `out`. Most
+ * scales only need a few taps, so those counts get unrolled loops.
+ */
+template<size_t N>
+static void resizeRow(const uint16_t* in, uint8_t* out, size_t w, size_t step, const ResizeTaps& taps) {
+	const uint32_t round = 1 << (RESIZE_SHIFT * 2 - 1);
+	size_t n = N ? N : taps.taps;
+	for (size_t x = 0; x < w; ++x) {
+		const uint16_t* pix = &in[taps.start[x]];
+		const uint16_t* weights = &taps.weights[x * n];
+		uint32_t sum = round;
+		for (size_t t = 0; t < n; ++t) {
+			sum += static_cast<uint32_t>(pix[t]) * weights[t];
+		}
+		out[x * step] = sum >> (RESIZE_SHIFT * 2);
+	}
+}
+
+static void resizeRow(const uint16_t* in, uint8_t* out, size_t w, size_t step, const ResizeTaps& taps) {
+	switch (taps.taps) {
+	case 1:
+		resizeRow<1>(in, out, w, step, taps);
+		break;
+	case 2:
+		resizeRow<2>(in, out, w, step, taps);
+		break;
+	case 3:
+		resizeRow<3>(in, out, w, step, taps);
+		break;
+	case 4:
+		resizeRow<4>(in, out, w, step, taps);
+		break;
+	default:
+		resizeRow<0>(in, out, w, step, taps);
+		break;
+	}
+}
+
+void imageResize(Image::Format format, const uint8_t* in, size_t stride, size_t x, size_t y, size_t w, size_t h, uint8_t* out, size_t outW, size_t outH, size_t outStride, bool gray, Image::Filter filter) {
+	const ResizeTaps& hTaps = cachedResizeTaps(w, outW, filter);
+	const ResizeTaps& vTaps = cachedResizeTaps(h, outH, filter);
+	size_t channels = gray ? 1 : 3;
+	size_t depth = format == Image::Format::RGB565 ? 2 : 4;
+
+	// Unpacked rows are kept in a ring, since consecutive output rows share
+	// source rows
+	vector<uint8_t> planes(vTaps.taps * w * channels);
+	vector<size_t> rowSource(vTaps.taps, SIZE_MAX);
+	vector<const uint8_t*> column(vTaps.taps);
+	vector<uint16_t> blended(w);
+
+	for (size_t oy = 0; oy < outH; ++oy) {
+		for (size_t t = 0; t < vTaps.taps; ++t) {
+			size_t sy = vTaps.start[oy] + t;
+			size_t slot = sy % vTaps.taps;
+			if (rowSource[slot] != sy) {
+				resizeUnpackRow(format, &in[(y + sy) * stride + x * depth], w, gray, &planes[slot * w * channels]);
+				rowSource[slot] = sy;
+			}
+		}
+
+		uint8_t* outRow = &out[oy * outStride];
+		for (size_t c = 0; c < channels; ++c) {
+			for (size_t t = 0; t < vTaps.taps; ++t) {
+				size_t slot = (vTaps.start[oy] + t) % vTaps.taps;
+				column[t] = &planes[(slot * channels + c) * w];
+			}
+			resizeColumn(column.data(), &vTaps.weights[oy * vTaps.taps], vTaps.taps, blended.data(), w);
+			resizeRow(blended.data(), &outRow[c], outW, channels, hTaps);
+		}
+	}
+}
+
 Image::Image(Format format, const void* in, size_t w, size_t h, size_t stride)
 	: m_constBuffer(in)
 	, m_w(w)
@@ -621,6 +1341,7 @@ Image::Image(Format format, void* in, size_t w, size_t h, size_t stride)
 }
 
 void Image::copyTo(Image* other) {
+	PerfTimer timer(PerfStage::IMAGE);
 	if (m_w != other->m_w || m_h != other->m_h) {
 		throw invalid_argument("Image dimensions don't match");
 	}
@@ -669,6 +1390,7 @@ void Image::copyTo(Image* other) {
 }
 
 void Image::halveTo(Image* other) {
+	PerfTimer timer(PerfStage::IMAGE);
 	if (m_w / 2 != other->m_w || m_h / 2 != other->m_h) {
 		throw invalid_argument("Image dimensions don't match");
 	}
@@ -732,6 +1454,7 @@ void Image::halveToInterlace(Image* other, const Image* old) {
 }
 
 void Image::quarterTo(Image* other) {
+	PerfTimer timer(PerfStage::IMAGE);
 	if (m_w / 4 != other->m_w || m_h / 4 != other->m_h) {
 		throw invalid_argument("Image dimensions don't match");
 	}
@@ -797,6 +1520,9 @@ void Image::quarterToInterlace(Image* other, const Image* old) {
 	}
 }
 
+/* Dividing has no kernels of its own, it dispatches to the copy, halve and
+ * quarter kernels and so uses their SSSE3 and WebAssembly SIMD paths
+ */
 void Image::divideTo(int divisor, Image* other) {
 	switch (divisor) {
 	case 0:
@@ -834,6 +1560,39 @@ void Image::divideToInterlace(int divisor, Image* other, const Image* old) {
 	}
 }
 
+void Image::resizeTo(Image* other, Filter filter) {
+	resizeTo(other, 0, 0, m_w, m_h, filter);
+}
+
+void Image::resizeTo(Image* other, size_t x, size_t y, size_t w, size_t h, Filter filter) {
+	PerfTimer timer(PerfStage::IMAGE);
+	if (!w || !h || x + w > m_w || y + h > m_h) {
+		throw invalid_argument("Crop exceeds image bounds");
+	}
+	if (!other->m_w || !other->m_h) {
+		throw invalid_argument("Image dimensions don't match");
+	}
+	bool gray;
+	switch (other->m_format) {
+	case Image::Format::G8:
+		gray = true;
+		break;
+	case Image::Format::RGB888:
+		gray = false;
+		break;
+	default:
+		throw logic_error("unimplemented conversion");
+	}
+	switch (m_format) {
+	case Image::Format::RGB565:
+	case Image::Format::RGBX888:
+		imageResize(m_format, static_cast<const uint8_t*>(m_constBuffer), m_stride, x, y, w, h, static_cast<uint8_t*>(other->m_buffer), other->m_w, other->m_h, other->m_stride, gray, filter);
+		break;
+	default:
+		throw logic_error("unimplemented conversion");
+	}
+}
+
 void Image::copyDirectlyTo(Image* other) {
 	size_t depth = 1;
 	switch (m_format) {
@@ -14,6 +14,11 @@ public:
 		G8
 	};
 
+	enum class Filter {
+		AREA,
+		BILINEAR
+	};
+
 	Image() {}
 	Image(Format, const void* in, size_t w, size_t h, size_t stride);
 	Image(Format, void* in, size_t w, size_t h, size_t stride);
@@ -26,15 +31,17 @@ public:
 	void quarterToInterlace(Image* other, const Image* old);
 	void divideTo(int divisor, Image* other);
 	void divideToInterlace(int divisor, Image* other, const Image* old);
+	void resizeTo(Image* other, Filter = Filter::AREA);
+	void resizeTo(Image* other, size_t x, size_t y, size_t w, size_t h, Filter = Filter::AREA);
 
 private:
 	void copyDirectlyTo(Image* other);
 
 	const void* m_constBuffer = nullptr;
 	void* m_buffer = nullptr;
-	size_t m_w;
-	size_t m_h;
-	size_t m_stride;
-	Format m_format;
+	size_t m_w = 0;
+	size_t m_h = 0;
+	size_t m_stride = 0;
+	Format m_format = Format::RGB565;
 };
 }
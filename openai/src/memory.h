@@ -1,6 +1,11 @@
 #pragma once
 
+#ifndef __EMSCRIPTEN__
 #include "gtest/gtest.h"
+#else
+// gtest isn't available to browser builds; only FRIEND_TEST is needed here
+#define FRIEND_TEST(test_case_name, test_name) friend class test_case_name##_##test_name##_Test
+#endif
 
 #include <functional>
 #include <map>
@@ -0,0 +1,159 @@
+#include "observation.h"
+
+#include "emulator.h"
+#include "perf.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace Retro;
+using namespace std;
+
+ObservationPipeline::ObservationPipeline(const Config& config, size_t screenWidth, size_t screenHeight)
+	: m_config(config) {
+	if (!m_config.stack) {
+		throw invalid_argument("Frame stack must hold at least one frame");
+	}
+	if (m_config.cropX + m_config.cropWidth > screenWidth || m_config.cropY + m_config.cropHeight > screenHeight) {
+		throw invalid_argument("Crop exceeds image bounds");
+	}
+	size_t cropWidth = m_config.cropWidth ? m_config.cropWidth : screenWidth - m_config.cropX;
+	size_t cropHeight = m_config.cropHeight ? m_config.cropHeight : screenHeight - m_config.cropY;
+	m_width = m_config.width ? m_config.width : cropWidth;
+	m_height = m_config.height ? m_config.height : cropHeight;
+	if (!m_width || !m_height) {
+		throw invalid_argument("Image dimensions don't match");
+	}
+	if (m_config.indexed) {
+		if (m_config.gray || m_config.maxPool) {
+			throw invalid_argument("Indexed observations can't be converted or pooled");
+		}
+		if (m_width != cropWidth || m_height != cropHeight) {
+			throw invalid_argument("Indexed observations can't be resized");
+		}
+	}
+
+	m_frames.resize(frameSize() * m_config.stack * 2);
+}
+
+void ObservationPipeline::copyIndexed(Emulator& emulator, uint8_t* out) {
+	if (!emulator.hasIndexedImage()) {
+		throw runtime_error("Core doesn't provide indexed frames");
+	}
+	size_t screenWidth = emulator.getIndexedImageWidth();
+	size_t screenHeight = emulator.getIndexedImageHeight();
+	if (m_config.cropX + m_width > screenWidth || m_config.cropY + m_height > screenHeight) {
+		throw runtime_error("Crop exceeds image bounds");
+	}
+	size_t pitch = emulator.getIndexedImagePitch();
+	const uint8_t* in = emulator.getIndexedImageData() + m_config.cropY * pitch + m_config.cropX;
+	for (size_t y = 0; y < m_height; ++y) {
+		memcpy(&out[y * m_width], &in[y * pitch], m_width);
+	}
+}
+
+void ObservationPipeline::convert(Emulator& emulator, uint8_t* out) {
+	if (m_config.indexed) {
+		copyIndexed(emulator, out);
+		return;
+	}
+	if (emulator.indexedOnly() || !emulator.getImageData()) {
+		throw runtime_error("No RGB frame available, indexed-only frames are enabled");
+	}
+
+	size_t screenWidth = emulator.getImageWidth();
+	size_t screenHeight = emulator.getImageHeight();
+	Image::Format format;
+	switch (emulator.getImageDepth()) {
+	case 16:
+		format = Image::Format::RGB565;
+		break;
+	case 32:
+		format = Image::Format::RGBX888;
+		break;
+	default:
+		throw logic_error("unimplemented conversion");
+	}
+
+	// Some cores change resolution while running, so uncropped dimensions
+	// follow the current screen
+	size_t x = m_config.cropX;
+	size_t y = m_config.cropY;
+	size_t w = m_config.cropWidth ? m_config.cropWidth : screenWidth - min(x, screenWidth);
+	size_t h = m_config.cropHeight ? m_config.cropHeight : screenHeight - min(y, screenHeight);
+
+	Image frame(m_config.gray ? Image::Format::G8 : Image::Format::RGB888, out, m_width, m_height, m_width * channels());
+	if (m_config.maxPool) {
+		pool(emulator, format, x, y, w, h).resizeTo(&frame, m_config.filter);
+	} else {
+		Image in(format, emulator.getImageData(), screenWidth, screenHeight, emulator.getImagePitch());
+		in.resizeTo(&frame, x, y, w, h, m_config.filter);
+	}
+}
+
+Image ObservationPipeline::pool(Emulator& emulator, Image::Format format, size_t x, size_t y, size_t w, size_t h) {
+	if (!w || !h || x + w > emulator.getImageWidth() || y + h > emulator.getImageHeight()) {
+		throw invalid_argument("Crop exceeds image bounds");
+	}
+	const uint8_t* in = static_cast<const uint8_t*>(emulator.getImageData());
+	size_t pitch = emulator.getImagePitch();
+	size_t depth = format == Image::Format::RGB565 ? 2 : 4;
+	size_t row = w * depth;
+	size_t size = row * h;
+	bool first = m_empty || m_previous.size() != size;
+	m_previous.resize(size);
+	m_pooled.resize(size);
+
+	for (size_t i = 0; i < h; ++i) {
+		const uint8_t* current = &in[(y + i) * pitch + x * depth];
+		uint8_t* previous = &m_previous[i * row];
+		uint8_t* pooled = &m_pooled[i * row];
+		if (first) {
+			memcpy(previous, current, row);
+		}
+		if (format == Image::Format::RGB565) {
+			// Each 5/6/5 field is compared on its own
+			const uint16_t* a = reinterpret_cast<const uint16_t*>(current);
+			const uint16_t* b = reinterpret_cast<const uint16_t*>(previous);
+			uint16_t* o = reinterpret_cast<uint16_t*>(pooled);
+			for (size_t j = 0; j < w; ++j) {
+				o[j] = max(a[j] & 0xF800, b[j] & 0xF800) | max(a[j] & 0x07E0, b[j] & 0x07E0) | max(a[j] & 0x001F, b[j] & 0x001F);
+			}
+		} else {
+			for (size_t j = 0; j < row; ++j) {
+				pooled[j] = max(current[j], previous[j]);
+			}
+		}
+		memcpy(previous, current, row);
+	}
+	return Image(format, m_pooled.data(), w, h, row);
+}
+
+void ObservationPipeline::push(Emulator& emulator) {
+	PerfTimer timer(PerfStage::OBSERVATION);
+	size_t size = frameSize();
+	size_t stack = m_config.stack;
+
+	// The newest frame goes at the end of the contiguous window
+	m_head = m_empty ? 0 : (m_head + 1) % stack;
+	uint8_t* newest = &m_frames[((m_head + stack - 1) % stack) * size];
+
+	convert(emulator, newest);
+
+	if (m_empty) {
+		// Start with a stack full of the first frame
+		for (size_t i = 0; i < stack * 2; ++i) {
+			if (&m_frames[i * size] != newest) {
+				memcpy(&m_frames[i * size], newest, size);
+			}
+		}
+		m_empty = false;
+	} else {
+		memcpy(newest + stack * size, newest, size);
+	}
+}
+
+void ObservationPipeline::reset() {
+	m_empty = true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "imageops.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Retro {
+
+class Emulator;
+
+/* Turns emulator frames into agent observations: crop, resize, optional
+ * grayscale, max-pooling of consecutive frames and frame stacking.
+ *
+ * Max-pooling takes the per-channel max of the raw cropped frames, before
+ * any conversion, so sprites that flicker between frames keep their colour.
+ *
+ * The stack is kept as a ring in which every frame is stored twice, so that
+ * the last `stack` frames are always contiguous, oldest first. Each push
+ * converts only the newest frame and data() can be exposed without copying.
+ *
+ * Indexed observations take the palette indices straight from cores that
+ * provide them, skipping RGB conversion entirely.
+ */
+class ObservationPipeline {
+public:
+	struct Config {
+		size_t width = 0; // 0 keeps the (cropped) screen width
+		size_t height = 0; // 0 keeps the (cropped) screen height
+		bool gray = false;
+		Image::Filter filter = Image::Filter::AREA;
+		size_t cropX = 0;
+		size_t cropY = 0;
+		size_t cropWidth = 0; // 0 crops nothing
+		size_t cropHeight = 0;
+		unsigned stack = 1;
+		bool maxPool = false; // Max of each frame and the one before it
+		bool indexed = false; // Raw palette indices, cropped but not resized
+	};
+
+	ObservationPipeline(const Config&, size_t screenWidth, size_t screenHeight);
+
+	void push(Emulator&);
+	void reset();
+	bool empty() const { return m_empty; }
+
+	const uint8_t* data() const { return &m_frames[m_head * frameSize()]; }
+	size_t width() const { return m_width; }
+	size_t height() const { return m_height; }
+	size_t channels() const { return m_config.gray || m_config.indexed ? 1 : 3; }
+	unsigned stack() const { return m_config.stack; }
+	size_t frameSize() const { return m_width * m_height * channels(); }
+
+private:
+	void convert(Emulator&, uint8_t* out);
+	void copyIndexed(Emulator&, uint8_t* out);
+	Image pool(Emulator&, Image::Format, size_t x, size_t y, size_t w, size_t h);
+
+	Config m_config;
+	size_t m_width;
+	size_t m_height;
+
+	// 2 * stack frames, frame i is mirrored at i + stack
+	std::vector<uint8_t> m_frames;
+	size_t m_head = 0;
+	bool m_empty = true;
+
+	// The previous raw cropped frame and the pooled one, for max-pooling
+	std::vector<uint8_t> m_previous;
+	std::vector<uint8_t> m_pooled;
+};
+}
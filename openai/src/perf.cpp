@@ -0,0 +1,140 @@
+#include "perf.h"
+
+#include <fstream>
+
+using namespace Retro;
+using namespace std;
+
+atomic<bool> PerfStats::s_enabled{ false };
+atomic<bool> PerfStats::s_tracing{ false };
+mutex PerfStats::s_mutex;
+PerfClock::time_point PerfStats::s_epoch;
+array<PerfHistogram, static_cast<size_t>(PerfStage::COUNT)> PerfStats::s_histograms;
+vector<PerfStats::TraceEvent> PerfStats::s_trace;
+
+// Small per-thread ids for the trace, in order of first use
+static unsigned traceThread() {
+	static atomic<unsigned> s_nextThread{ 0 };
+	thread_local unsigned thread = s_nextThread++;
+	return thread;
+}
+
+const char* Retro::perfStageName(PerfStage stage) {
+	switch (stage) {
+	case PerfStage::STEP:
+		return "step";
+	case PerfStage::CORE_RUN:
+		return "core_run";
+	case PerfStage::VIDEO_REFRESH:
+		return "video_refresh";
+	case PerfStage::AUDIO_BATCH:
+		return "audio_batch";
+	case PerfStage::IMAGE:
+		return "image";
+	case PerfStage::UPDATE_RAM:
+		return "update_ram";
+	case PerfStage::SCENARIO_UPDATE:
+		return "scenario_update";
+	case PerfStage::SCRIPT_CALL:
+		return "script_call";
+	case PerfStage::OBSERVATION:
+		return "observation";
+	case PerfStage::BINDING:
+		return "binding";
+	case PerfStage::COUNT:
+		break;
+	}
+	return "unknown";
+}
+
+void PerfHistogram::add(uint64_t ns) {
+	if (!count || ns < minNs) {
+		minNs = ns;
+	}
+	if (ns > maxNs) {
+		maxNs = ns;
+	}
+	++count;
+	totalNs += ns;
+
+	unsigned bucket = 0;
+	while (ns > 1 && bucket + 1 < BUCKETS) {
+		ns >>= 1;
+		++bucket;
+	}
+	++buckets[bucket];
+}
+
+uint64_t PerfHistogram::percentileNs(double fraction) const {
+	uint64_t target = count * fraction;
+	uint64_t seen = 0;
+	for (unsigned i = 0; i < BUCKETS; ++i) {
+		seen += buckets[i];
+		if (seen > target) {
+			return min(uint64_t(2) << i, maxNs);
+		}
+	}
+	return maxNs;
+}
+
+void PerfStats::setEnabled(bool enabled, bool trace) {
+	lock_guard<mutex> lock(s_mutex);
+	if (enabled && !s_enabled) {
+		s_epoch = PerfClock::now();
+	}
+	s_enabled = enabled;
+	s_tracing = enabled && trace;
+}
+
+void PerfStats::reset() {
+	lock_guard<mutex> lock(s_mutex);
+	s_histograms.fill(PerfHistogram());
+	s_trace.clear();
+	s_epoch = PerfClock::now();
+}
+
+void PerfStats::record(PerfStage stage, PerfClock::time_point start, PerfClock::time_point end) {
+	uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+	unsigned thread = traceThread();
+	lock_guard<mutex> lock(s_mutex);
+	s_histograms[static_cast<size_t>(stage)].add(ns);
+	if (s_tracing && s_trace.size() < MAX_TRACE_EVENTS) {
+		uint64_t startNs = chrono::duration_cast<chrono::nanoseconds>(start - s_epoch).count();
+		s_trace.push_back(TraceEvent{ stage, startNs, ns, thread });
+	}
+}
+
+PerfHistogram PerfStats::histogram(PerfStage stage) {
+	lock_guard<mutex> lock(s_mutex);
+	return s_histograms[static_cast<size_t>(stage)];
+}
+
+size_t PerfStats::traceEvents() {
+	lock_guard<mutex> lock(s_mutex);
+	return s_trace.size();
+}
+
+bool PerfStats::writeTrace(const string& path) {
+	ofstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	// Complete ("X") events, with times in microseconds
+	lock_guard<mutex> lock(s_mutex);
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	file.precision(3);
+	file << fixed;
+	bool first = true;
+	for (const auto& event : s_trace) {
+		if (!first) {
+			file << ',';
+		}
+		first = false;
+		file << "\n{\"name\":\"" << perfStageName(event.stage) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread
+		     << ",\"ts\":" << event.startNs / 1000.
+		     << ",\"dur\":" << event.durationNs / 1000. << '}';
+	}
+	file << "\n]}\n";
+	return file.good();
+}
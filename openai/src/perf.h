@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Retro {
+
+/* Stages of the step hot path that can be timed. Stages nest, e.g. CORE_RUN
+ * includes the VIDEO_REFRESH and AUDIO_BATCH callbacks made by the core.
+ */
+enum class PerfStage {
+	STEP,
+	CORE_RUN,
+	VIDEO_REFRESH,
+	AUDIO_BATCH,
+	IMAGE,
+	UPDATE_RAM,
+	SCENARIO_UPDATE,
+	SCRIPT_CALL,
+	OBSERVATION,
+	BINDING,
+	COUNT
+};
+
+const char* perfStageName(PerfStage);
+
+using PerfClock = std::chrono::steady_clock;
+
+struct PerfHistogram {
+	// Bucket i counts durations in [2^i, 2^(i+1)) nanoseconds
+	static const unsigned BUCKETS = 32;
+
+	uint64_t count = 0;
+	uint64_t totalNs = 0;
+	uint64_t minNs = 0;
+	uint64_t maxNs = 0;
+	std::array<uint64_t, BUCKETS> buckets{};
+
+	void add(uint64_t ns);
+
+	// Upper bound of the bucket holding the given fraction of samples
+	uint64_t percentileNs(double fraction) const;
+};
+
+/* Process-wide timing of the hot path, off by default. Scripts may run on
+ * their own threads, so samples are recorded under a lock that is only taken
+ * while timing is enabled. With tracing on, every timed span is also kept for
+ * export in the Chrome trace event format, up to MAX_TRACE_EVENTS.
+ */
+class PerfStats {
+public:
+	static const size_t MAX_TRACE_EVENTS = 1 << 20;
+
+	static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+	static bool tracing() { return s_tracing.load(std::memory_order_relaxed); }
+	static void setEnabled(bool enabled, bool trace = false);
+	static void reset();
+
+	static void record(PerfStage, PerfClock::time_point start, PerfClock::time_point end);
+	static PerfHistogram histogram(PerfStage);
+
+	static size_t traceEvents();
+	static bool writeTrace(const std::string& path);
+
+private:
+	struct TraceEvent {
+		PerfStage stage;
+		uint64_t startNs;
+		uint64_t durationNs;
+		unsigned thread;
+	};
+
+	static std::atomic<bool> s_enabled;
+	static std::atomic<bool> s_tracing;
+	static std::mutex s_mutex;
+	static PerfClock::time_point s_epoch;
+	static std::array<PerfHistogram, static_cast<size_t>(PerfStage::COUNT)> s_histograms;
+	static std::vector<TraceEvent> s_trace;
+};
+
+/* Times the enclosing scope. Costs a single branch while timing is disabled. */
+class PerfTimer {
+public:
+	PerfTimer(PerfStage stage)
+		: m_stage(stage)
+		, m_active(PerfStats::enabled()) {
+		if (m_active) {
+			m_start = PerfClock::now();
+		}
+	}
+	~PerfTimer() {
+		if (m_active) {
+			PerfStats::record(m_stage, m_start, PerfClock::now());
+		}
+	}
+	PerfTimer(const PerfTimer&) = delete;
+
+private:
+	PerfStage m_stage;
+	bool m_active;
+	PerfClock::time_point m_start;
+};
+}
@@ -0,0 +1,492 @@
+#include "coreinfo.h"
+#include "data.h"
+#include "emulator.h"
+#include "json.hpp"
+#include "movie.h"
+#include "tool-utils.h"
+#include "utils.h"
+
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+using namespace Retro;
+using namespace std;
+using nlohmann::json;
+
+using Clock = chrono::steady_clock;
+
+#ifndef RETRO_REPLAY_CORE_HINT
+#define RETRO_REPLAY_CORE_HINT "."
+#endif
+#ifndef RETRO_REPLAY_COREINFO_DIR
+#define RETRO_REPLAY_COREINFO_DIR ""
+#endif
+#ifndef RETRO_REPLAY_DATA_HINT
+#define RETRO_REPLAY_DATA_HINT "."
+#endif
+
+// Integration directories searched under the data path, in order
+static const char* const INTEGRATIONS[] = { "stable", "contrib", "experimental" };
+
+struct Options {
+	unsigned jobs = max(thread::hardware_concurrency(), 1u);
+	unsigned checkpoint = 60;
+	bool rerun = false;
+	string scenario = "scenario";
+	string reference;
+	string output;
+	vector<string> dataDirs;
+	vector<string> movies;
+};
+
+// A single replay of a movie, before it is compared against anything
+struct Replay {
+	uint64_t frames = 0;
+	vector<string> checkpoints;
+	string ramHash;
+	string stateHash;
+	json reward = json::array();
+	json doneFrame;
+	double us = 0;
+};
+
+static bool isDirectory(const string& path) {
+	struct stat statbuf;
+	return stat(path.c_str(), &statbuf) == 0 && S_ISDIR(statbuf.st_mode);
+}
+
+static bool isFile(const string& path) {
+	struct stat statbuf;
+	return stat(path.c_str(), &statbuf) == 0 && S_ISREG(statbuf.st_mode);
+}
+
+static void findMovies(const string& path, vector<string>* movies) {
+	if (!isDirectory(path)) {
+		movies->emplace_back(path);
+		return;
+	}
+	for (const auto& entry : listDirectory(path)) {
+		if (isDirectory(entry)) {
+			findMovies(entry, movies);
+		} else if (hasSuffix(entry, ".bk2") || hasSuffix(entry, ".fm2")) {
+			movies->emplace_back(entry);
+		}
+	}
+}
+
+// Hashes are printed as hex so the JSON stays exact
+static string hexHash(uint64_t hash) {
+	char hex[17];
+	snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+	return hex;
+}
+
+static string hashRam(const GameData& data) {
+	uint64_t hash = fnv1a(nullptr, 0);
+	for (const auto& block : data.addressSpace().blocks()) {
+		hash = fnv1a(block.second.offset(0), block.second.size(), hash);
+	}
+	return hexHash(hash);
+}
+
+static string findGame(const string& game, const Options& options) {
+	vector<string> directories = options.dataDirs;
+	string base = GameData::dataPath(RETRO_REPLAY_DATA_HINT);
+	for (const char* integration : INTEGRATIONS) {
+		directories.emplace_back(base + "/" + integration);
+	}
+	for (const auto& directory : directories) {
+		if (isDirectory(directory + "/" + game)) {
+			return directory + "/" + game;
+		}
+	}
+	return {};
+}
+
+static string findRom(const string& directory) {
+	for (const auto& extension : extensions()) {
+		string path = directory + "/rom." + extension;
+		if (isFile(path)) {
+			return path;
+		}
+	}
+	return {};
+}
+
+static Replay replay(const string& path, const string& directory, const Options& options) {
+	unique_ptr<Movie> movie = Movie::load(path);
+	if (!movie) {
+		throw runtime_error("could not load movie");
+	}
+
+	Emulator emulator;
+	if (!emulator.loadRom(findRom(directory))) {
+		throw runtime_error("could not load ROM");
+	}
+	GameData data;
+	Scenario scenario(data);
+	if (!data.load(directory + "/data.json")) {
+		throw runtime_error("could not load data.json");
+	}
+	string scenarioPath = directory + "/" + options.scenario + ".json";
+	if (isFile(scenarioPath) && !scenario.load(scenarioPath)) {
+		throw runtime_error("could not load " + options.scenario + ".json");
+	}
+	emulator.configureData(&data);
+
+	vector<uint8_t> state;
+	if (movie->getState(&state) && state.size() && !emulator.unserialize(state.data(), state.size())) {
+		throw runtime_error("could not load the movie's starting state");
+	}
+
+	// Same order as resetting an environment
+	scenario.restart();
+	scenario.reloadScripts();
+	data.updateRam();
+	scenario.update();
+
+	Replay result;
+	unsigned players = min(movie->players(), static_cast<unsigned>(MAX_PLAYERS));
+	vector<double> reward(players);
+	auto start = Clock::now();
+	while (movie->step()) {
+		for (unsigned player = 0; player < players; ++player) {
+			for (int key = 0; key < N_BUTTONS; ++key) {
+				emulator.setKey(player, key, movie->getKey(key, player));
+			}
+		}
+		emulator.run();
+		data.updateRam();
+		scenario.update();
+		++result.frames;
+
+		for (unsigned player = 0; player < players; ++player) {
+			reward[player] += scenario.currentReward(player);
+		}
+		if (result.doneFrame.is_null() && scenario.isDone()) {
+			result.doneFrame = result.frames;
+		}
+		if (options.checkpoint && result.frames % options.checkpoint == 0) {
+			result.checkpoints.emplace_back(hashRam(data));
+		}
+	}
+	result.us = elapsedUs(start);
+
+	result.ramHash = hashRam(data);
+	state.resize(emulator.serializeSize());
+	if (state.size() && emulator.serialize(state.data(), state.size())) {
+		result.stateHash = hexHash(fnv1a(state.data(), state.size()));
+	}
+	for (double total : reward) {
+		result.reward.push_back(total);
+	}
+	return result;
+}
+
+// First frame where two replays of the same movie disagree, or null
+static json divergence(const json& a, const json& b, const Options& options) {
+	json checkpointsA = a.value("checkpoints", json::array());
+	json checkpointsB = b.value("checkpoints", json::array());
+	uint64_t frame = 0;
+	for (size_t i = 0; i < min(checkpointsA.size(), checkpointsB.size()); ++i) {
+		if (checkpointsA[i] != checkpointsB[i]) {
+			return { { "after", frame }, { "by", (i + 1) * options.checkpoint } };
+		}
+		frame = (i + 1) * options.checkpoint;
+	}
+	if (a["frames"] != b["frames"] || a["ram_hash"] != b["ram_hash"] || a["state_hash"] != b["state_hash"] || a["reward"] != b["reward"]) {
+		uint64_t frames = min(a["frames"].get<uint64_t>(), b["frames"].get<uint64_t>());
+		return { { "after", frame }, { "by", frames } };
+	}
+	return nullptr;
+}
+
+static json toJson(const Replay& replay) {
+	return {
+		{ "frames", replay.frames },
+		{ "fps", replay.us ? replay.frames * 1e6 / replay.us : 0 },
+		{ "ram_hash", replay.ramHash },
+		{ "state_hash", replay.stateHash },
+		{ "reward", replay.reward },
+		{ "done_frame", replay.doneFrame },
+		{ "checkpoints", replay.checkpoints },
+	};
+}
+
+static json validate(const string& path, const Options& options) {
+	json result = { { "movie", path } };
+	try {
+		unique_ptr<Movie> movie = Movie::load(path);
+		if (!movie) {
+			throw runtime_error("could not load movie");
+		}
+		string game = movie->getGameName();
+		result["game"] = game;
+		result["players"] = movie->players();
+		movie.reset();
+
+		string directory = findGame(game, options);
+		if (directory.empty()) {
+			throw runtime_error("unknown game " + game);
+		}
+		if (findRom(directory).empty()) {
+			throw runtime_error("no ROM for " + game);
+		}
+
+		result.update(toJson(replay(path, directory, options)));
+		if (options.rerun) {
+			json rerun = toJson(replay(path, directory, options));
+			json diverged = divergence(result, rerun, options);
+			if (!diverged.is_null()) {
+				diverged["against"] = "rerun";
+				result["divergence"] = diverged;
+			}
+		}
+	} catch (exception& e) {
+		result["error"] = e.what();
+	}
+	return result;
+}
+
+// Cores keep global state, so every movie is replayed in its own process
+static pid_t spawn(const string& path, const Options& options, int* fd) {
+	int pipefd[2];
+	if (pipe(pipefd) < 0) {
+		return -1;
+	}
+	cout.flush();
+	cerr.flush();
+	pid_t pid = fork();
+	if (pid < 0) {
+		close(pipefd[0]);
+		close(pipefd[1]);
+		return -1;
+	}
+	if (!pid) {
+		close(pipefd[0]);
+		string result = validate(path, options).dump();
+		const char* data = result.data();
+		size_t remaining = result.size();
+		while (remaining) {
+			ssize_t written = write(pipefd[1], data, remaining);
+			if (written < 0 && errno == EINTR) {
+				continue;
+			}
+			if (written <= 0) {
+				_exit(1);
+			}
+			data += written;
+			remaining -= written;
+		}
+		_exit(0);
+	}
+	close(pipefd[1]);
+	*fd = pipefd[0];
+	return pid;
+}
+
+struct Worker {
+	pid_t pid;
+	int fd;
+	size_t movie;
+	string output;
+};
+
+static json finish(Worker& worker, const Options& options) {
+	close(worker.fd);
+	int status = 0;
+	while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {
+	}
+	try {
+		if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+			return json::parse(worker.output);
+		}
+	} catch (json::exception&) {
+	}
+	json result = { { "movie", options.movies[worker.movie] } };
+	if (WIFSIGNALED(status)) {
+		result["error"] = "replay crashed with signal " + to_string(WTERMSIG(status));
+	} else {
+		result["error"] = "replay exited with status " + to_string(WEXITSTATUS(status));
+	}
+	return result;
+}
+
+static vector<json> replayAll(const Options& options) {
+	vector<json> results(options.movies.size());
+	vector<Worker> workers;
+	size_t next = 0;
+	size_t done = 0;
+	while (done < options.movies.size()) {
+		while (workers.size() < options.jobs && next < options.movies.size()) {
+			int fd;
+			pid_t pid = spawn(options.movies[next], options, &fd);
+			if (pid < 0) {
+				results[next] = { { "movie", options.movies[next] }, { "error", "could not start replay" } };
+				++next;
+				++done;
+				continue;
+			}
+			workers.push_back({ pid, fd, next, {} });
+			++next;
+		}
+		if (workers.empty()) {
+			continue;
+		}
+
+		vector<struct pollfd> fds;
+		for (const auto& worker : workers) {
+			fds.push_back({ worker.fd, POLLIN, 0 });
+		}
+		if (poll(fds.data(), fds.size(), -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw runtime_error("poll failed");
+		}
+		for (size_t i = fds.size(); i--;) {
+			if (!fds[i].revents) {
+				continue;
+			}
+			Worker& worker = workers[i];
+			char buffer[4096];
+			ssize_t bytes = read(worker.fd, buffer, sizeof(buffer));
+			if (bytes > 0) {
+				worker.output.append(buffer, bytes);
+				continue;
+			}
+			if (bytes < 0 && errno == EINTR) {
+				continue;
+			}
+			results[worker.movie] = finish(worker, options);
+			cerr << "[" << ++done << "/" << options.movies.size() << "] " << options.movies[worker.movie] << endl;
+			workers.erase(workers.begin() + i);
+		}
+	}
+	return results;
+}
+
+static void usage(const char* argv0) {
+	cerr << "Usage: " << argv0 << " [-j JOBS] [-k INTERVAL] [-d DATA]... [-s SCENARIO] [-c REFERENCE] [-r] [-o OUTPUT] MOVIE..." << endl
+	     << endl
+	     << "Replays movies without rendering and prints a JSON summary of each one's" << endl
+	     << "final RAM and state hashes, reward totals and the frame its scenario ended." << endl
+	     << "Directories are searched recursively for .bk2 and .fm2 files." << endl
+	     << endl
+	     << "-j replays up to JOBS movies at once, each in its own process." << endl
+	     << "-k hashes RAM every INTERVAL frames to locate divergences (default 60, 0 disables)." << endl
+	     << "-d looks for game integrations in DATA before the data path." << endl
+	     << "-s scores with SCENARIO.json from each game's integration (default scenario)." << endl
+	     << "-c compares against an earlier summary and reports where replays diverged." << endl
+	     << "-r replays every movie twice to check that it is deterministic." << endl;
+}
+
+int main(int argc, char** argv) {
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if ((arg == "-j" || arg == "-k" || arg == "-d" || arg == "-s" || arg == "-c" || arg == "-o") && i + 1 < argc) {
+			string value = argv[++i];
+			if (arg == "-j") {
+				options.jobs = stoul(value);
+			} else if (arg == "-k") {
+				options.checkpoint = stoul(value);
+			} else if (arg == "-d") {
+				options.dataDirs.emplace_back(value);
+			} else if (arg == "-s") {
+				options.scenario = value;
+			} else if (arg == "-c") {
+				options.reference = value;
+			} else {
+				options.output = value;
+			}
+		} else if (arg == "-r") {
+			options.rerun = true;
+		} else if (arg[0] == '-') {
+			usage(argv[0]);
+			return 1;
+		} else {
+			findMovies(arg, &options.movies);
+		}
+	}
+	if (!options.jobs || options.movies.empty()) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (!loadCores(RETRO_REPLAY_CORE_HINT, RETRO_REPLAY_COREINFO_DIR)) {
+		cerr << "No core info found in " << corePath() << endl;
+		return 1;
+	}
+
+	unordered_map<string, json> reference;
+	if (!options.reference.empty()) {
+		ifstream file(options.reference);
+		json summary;
+		try {
+			file >> summary;
+		} catch (json::exception&) {
+			cerr << "Could not read " << options.reference << endl;
+			return 1;
+		}
+		bool comparable = summary.value("checkpoint_interval", 0u) == options.checkpoint;
+		for (auto result : summary["results"]) {
+			if (!comparable) {
+				// Checkpoints taken at other intervals can't be matched up
+				result.erase("checkpoints");
+			}
+			reference[result["movie"].get<string>()] = result;
+		}
+	}
+
+	auto start = Clock::now();
+	vector<json> results = replayAll(options);
+
+	size_t failed = 0;
+	size_t diverged = 0;
+	for (auto& result : results) {
+		if (result.count("error")) {
+			++failed;
+			continue;
+		}
+		const auto& previous = reference.find(result["movie"].get<string>());
+		if (result.count("divergence") == 0 && previous != reference.end() && !previous->second.count("error")) {
+			json found = divergence(previous->second, result, options);
+			if (!found.is_null()) {
+				found["against"] = "reference";
+				result["divergence"] = found;
+			}
+		}
+		if (result.count("divergence")) {
+			++diverged;
+		}
+	}
+
+	json summary = {
+		{ "movies", results.size() },
+		{ "failed", failed },
+		{ "diverged", diverged },
+		{ "checkpoint_interval", options.checkpoint },
+		{ "scenario", options.scenario },
+		{ "seconds", elapsedUs(start) / 1e6 },
+		{ "results", results },
+	};
+	if (options.output.empty()) {
+		cout << summary.dump(2) << endl;
+	} else {
+		ofstream(options.output) << summary.dump(2) << endl;
+	}
+	return failed || diverged ? 2 : 0;
+}
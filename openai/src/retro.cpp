@@ -17,11 +17,13 @@ static inline T _hypot(T x, T y) {
 #include "imageops.h"
 #include "memory.h"
 #include "search.h"
-#include "script.h"
 #include "movie.h"
 #include "movie-bk2.h"
+#include "observation.h"
+#include "perf.h"
 
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -30,9 +32,39 @@ namespace py = pybind11;
 using std::string;
 using namespace Retro;
 
+static void enablePerfStats(bool enabled, bool trace) {
+	PerfStats::setEnabled(enabled, trace);
+}
+
+static py::dict perfStats() {
+	py::dict stats;
+	for (size_t i = 0; i < static_cast<size_t>(PerfStage::COUNT); ++i) {
+		PerfStage stage = static_cast<PerfStage>(i);
+		const PerfHistogram& hist = PerfStats::histogram(stage);
+		if (!hist.count) {
+			continue;
+		}
+		py::list buckets;
+		for (uint64_t bucket : hist.buckets) {
+			buckets.append(bucket);
+		}
+		stats[perfStageName(stage)] = py::dict(
+			py::arg("count") = hist.count,
+			py::arg("total_us") = hist.totalNs / 1000.,
+			py::arg("mean_us") = hist.totalNs / 1000. / hist.count,
+			py::arg("min_us") = hist.minNs / 1000.,
+			py::arg("max_us") = hist.maxNs / 1000.,
+			py::arg("p50_us") = hist.percentileNs(0.5) / 1000.,
+			py::arg("p99_us") = hist.percentileNs(0.99) / 1000.,
+			py::arg("histogram_ns") = buckets);
+	}
+	return stats;
+}
+
 struct PyGameData;
 struct PyRetroEmulator {
 	Retro::Emulator m_re;
+	std::unique_ptr<ObservationPipeline> m_observation;
 	int m_cheats = 0;
 	PyRetroEmulator(const string& rom_path) {
 		if (Emulator::isLoaded()) {
@@ -45,10 +77,15 @@ struct PyRetroEmulator {
 	}
 
 	void step() {
+		PerfTimer timer(PerfStage::STEP);
 		m_re.run();
+		if (m_observation) {
+			m_observation->push(m_re);
+		}
 	}
 
 	py::bytes getState() {
+		PerfTimer timer(PerfStage::BINDING);
 		size_t size = m_re.serializeSize();
 		py::bytes bytes(NULL, size);
 		m_re.serialize(PyBytes_AsString(bytes.ptr()), size);
@@ -56,10 +93,35 @@ struct PyRetroEmulator {
 	}
 
 	bool setState(py::bytes o) {
+		PerfTimer timer(PerfStage::BINDING);
+		if (m_observation) {
+			m_observation->reset();
+		}
 		return m_re.unserialize(PyBytes_AsString(o.ptr()), PyBytes_Size(o.ptr()));
 	}
 
+	py::bytes snapshotDelta(py::bytes base) {
+		PerfTimer timer(PerfStage::BINDING);
+		std::vector<uint8_t> delta;
+		if (!m_re.snapshotDelta(PyBytes_AsString(base.ptr()), PyBytes_Size(base.ptr()), &delta)) {
+			throw std::runtime_error("Failed to snapshot state");
+		}
+		return py::bytes(reinterpret_cast<const char*>(delta.data()), delta.size());
+	}
+
+	bool restoreDelta(py::bytes base, py::bytes delta) {
+		PerfTimer timer(PerfStage::BINDING);
+		if (m_observation) {
+			m_observation->reset();
+		}
+		return m_re.restoreDelta(PyBytes_AsString(base.ptr()), PyBytes_Size(base.ptr()), PyBytes_AsString(delta.ptr()), PyBytes_Size(delta.ptr()));
+	}
+
 	py::array_t<uint8_t> getScreen() {
+		PerfTimer timer(PerfStage::BINDING);
+		if (m_re.indexedOnly() || !m_re.getImageData()) {
+			throw std::runtime_error("No RGB frame available, indexed-only frames are enabled");
+		}
 		long w = m_re.getImageWidth();
 		long h = m_re.getImageHeight();
 		py::array_t<uint8_t> arr({ { h, w, 3 } });
@@ -75,11 +137,118 @@ struct PyRetroEmulator {
 		return arr;
 	}
 
+	py::array_t<uint8_t> getScreenResized(size_t width, size_t height, bool gray, bool bilinear, py::object crop) {
+		PerfTimer timer(PerfStage::BINDING);
+		if (m_re.indexedOnly() || !m_re.getImageData()) {
+			throw std::runtime_error("No RGB frame available, indexed-only frames are enabled");
+		}
+		size_t w = m_re.getImageWidth();
+		size_t h = m_re.getImageHeight();
+		size_t x = 0;
+		size_t y = 0;
+		if (!crop.is_none()) {
+			py::tuple rect = crop.cast<py::tuple>();
+			if (rect.size() != 4) {
+				throw std::invalid_argument("crop must be a tuple of (x, y, width, height)");
+			}
+			x = rect[0].cast<size_t>();
+			y = rect[1].cast<size_t>();
+			w = rect[2].cast<size_t>();
+			h = rect[3].cast<size_t>();
+		}
+		size_t channels = gray ? 1 : 3;
+		py::array_t<uint8_t> arr({ height, width, channels });
+		uint8_t* data = arr.mutable_data();
+		Image out(gray ? Image::Format::G8 : Image::Format::RGB888, data, width, height, width * channels);
+		Image in;
+		switch (m_re.getImageDepth()) {
+		case 16:
+			in = Image(Image::Format::RGB565, m_re.getImageData(), m_re.getImageWidth(), m_re.getImageHeight(), m_re.getImagePitch());
+			break;
+		case 32:
+			in = Image(Image::Format::RGBX888, m_re.getImageData(), m_re.getImageWidth(), m_re.getImageHeight(), m_re.getImagePitch());
+			break;
+		default:
+			throw std::logic_error("unimplemented conversion");
+		}
+		in.resizeTo(&out, x, y, w, h, bilinear ? Image::Filter::BILINEAR : Image::Filter::AREA);
+		return arr;
+	}
+
+	py::array_t<uint8_t> getScreenIndexed() {
+		PerfTimer timer(PerfStage::BINDING);
+		if (!m_re.hasIndexedImage()) {
+			throw std::runtime_error("Core doesn't provide indexed frames");
+		}
+		size_t w = m_re.getIndexedImageWidth();
+		size_t h = m_re.getIndexedImageHeight();
+		size_t pitch = m_re.getIndexedImagePitch();
+		py::array_t<uint8_t> arr({ h, w });
+		uint8_t* data = arr.mutable_data();
+		const uint8_t* in = m_re.getIndexedImageData();
+		for (size_t y = 0; y < h; ++y) {
+			memcpy(&data[y * w], &in[y * pitch], w);
+		}
+		return arr;
+	}
+
+	py::array_t<uint8_t> getPalette() {
+		if (!m_re.getPalette()) {
+			throw std::runtime_error("Core doesn't provide a palette");
+		}
+		py::array_t<uint8_t> arr({ 256, 3 });
+		memcpy(arr.mutable_data(), m_re.getPalette(), 256 * 3);
+		return arr;
+	}
+
+	void setIndexedOnly(bool indexedOnly) {
+		m_re.setIndexedOnly(indexedOnly);
+	}
+
+	void configureObservation(size_t width, size_t height, bool gray, bool bilinear, py::object crop, unsigned stack, bool maxPool, bool indexed) {
+		ObservationPipeline::Config config;
+		config.width = width;
+		config.height = height;
+		config.gray = gray;
+		config.filter = bilinear ? Image::Filter::BILINEAR : Image::Filter::AREA;
+		if (!crop.is_none()) {
+			py::tuple rect = crop.cast<py::tuple>();
+			if (rect.size() != 4) {
+				throw std::invalid_argument("crop must be a tuple of (x, y, width, height)");
+			}
+			config.cropX = rect[0].cast<size_t>();
+			config.cropY = rect[1].cast<size_t>();
+			config.cropWidth = rect[2].cast<size_t>();
+			config.cropHeight = rect[3].cast<size_t>();
+		}
+		config.stack = stack;
+		config.maxPool = maxPool;
+		config.indexed = indexed;
+		m_observation.reset(new ObservationPipeline(config, m_re.getImageWidth(), m_re.getImageHeight()));
+	}
+
+	// The array is a read-only view of the frame stack, only valid until the
+	// next step. Writing to it would corrupt the frames kept for later steps.
+	py::array_t<uint8_t> getObservation(py::object self) {
+		PerfTimer timer(PerfStage::BINDING);
+		if (!m_observation) {
+			throw std::runtime_error("Observations are not configured, call configure_observation first");
+		}
+		if (m_observation->empty()) {
+			m_observation->push(m_re);
+		}
+		const ObservationPipeline& obs = *m_observation;
+		py::array_t<uint8_t> arr({ static_cast<size_t>(obs.stack()), obs.height(), obs.width(), obs.channels() }, obs.data(), self);
+		arr.attr("flags").attr("writeable") = false;
+		return arr;
+	}
+
 	double getScreenRate() {
 		return m_re.getFrameRate();
 	}
 
 	py::array_t<int16_t> getAudio() {
+		PerfTimer timer(PerfStage::BINDING);
 		py::array_t<int16_t> arr(py::array::ShapeContainer{ m_re.getAudioSamples(), 2 });
 		int16_t* data = arr.mutable_data();
 		memcpy(data, m_re.getAudioData(), m_re.getAudioSamples() * 4);
@@ -221,8 +390,6 @@ struct PyGameData {
 	Retro::Scenario m_scen{ m_data };
 
 	bool load(py::handle data = py::none(), py::handle scen = py::none()) {
-		ScriptContext::reset();
-
 		bool success = true;
 		if (!data.is_none()) {
 			success = success && m_data.load(py::str(data));
@@ -468,7 +635,15 @@ PYBIND11_MODULE(_retro, m) {
 		.def("set_button_mask", &PyRetroEmulator::setButtonMask, py::arg("mask"), py::arg("player") = 0)
 		.def("get_state", &PyRetroEmulator::getState)
 		.def("set_state", &PyRetroEmulator::setState)
+		.def("snapshot_delta", &PyRetroEmulator::snapshotDelta, py::arg("base"))
+		.def("restore_delta", &PyRetroEmulator::restoreDelta, py::arg("base"), py::arg("delta"))
 		.def("get_screen", &PyRetroEmulator::getScreen)
+		.def("get_screen_resized", &PyRetroEmulator::getScreenResized, py::arg("width"), py::arg("height"), py::arg("gray") = false, py::arg("bilinear") = false, py::arg("crop") = py::none())
+		.def("configure_observation", &PyRetroEmulator::configureObservation, py::arg("width") = 0, py::arg("height") = 0, py::arg("gray") = false, py::arg("bilinear") = false, py::arg("crop") = py::none(), py::arg("stack") = 1, py::arg("max_pool") = false, py::arg("indexed") = false)
+		.def("get_screen_indexed", &PyRetroEmulator::getScreenIndexed)
+		.def("get_palette", &PyRetroEmulator::getPalette)
+		.def("set_indexed_only", &PyRetroEmulator::setIndexedOnly, py::arg("indexed_only") = true)
+		.def("get_observation", [](py::object self) { return self.cast<PyRetroEmulator&>().getObservation(self); })
 		.def("get_screen_rate", &PyRetroEmulator::getScreenRate)
 		.def("get_audio", &PyRetroEmulator::getAudio)
 		.def("get_audio_rate", &PyRetroEmulator::getAudioRate)
@@ -476,6 +651,10 @@ PYBIND11_MODULE(_retro, m) {
 		.def("configure_data", &PyRetroEmulator::configureData)
 		.def("add_cheat", &PyRetroEmulator::addCheat)
 		.def("clear_cheats", &PyRetroEmulator::clearCheats)
+		.def_static("enable_perf_stats", &enablePerfStats, py::arg("enabled") = true, py::arg("trace") = false)
+		.def_static("perf_stats", &perfStats)
+		.def_static("reset_perf_stats", &PerfStats::reset)
+		.def_static("write_perf_trace", &PerfStats::writeTrace, py::arg("path"))
 		.def_static("load_core_info", &PyRetroEmulator::loadCoreInfo);
 
 	py::class_<PyMemoryView>(m, "Memory")
@@ -498,6 +677,7 @@ PYBIND11_MODULE(_retro, m) {
 		.def("load", &PyGameData::load, py::arg("data") = py::none(), py::arg("scen") = py::none())
 		.def("save", &PyGameData::save, py::arg("data") = py::none(), py::arg("scen") = py::none())
 		.def("reset", &PyGameData::reset)
+		.def_static("perf_stats", &perfStats)
 		.def("filter_action", &PyGameData::filterAction)
 		.def("valid_actions", &PyGameData::validActions)
 		.def("update_ram", &PyGameData::updateRam)
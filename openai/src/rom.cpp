@@ -0,0 +1,142 @@
+#include "rom.h"
+
+#include "utils.h"
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <utility>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Retro;
+using namespace std;
+
+struct FileStamp {
+	uint64_t size = 0;
+	int64_t mtime = 0;
+
+	bool operator==(const FileStamp& other) const {
+		return size == other.size && mtime == other.mtime;
+	}
+};
+
+struct PathEntry {
+	FileStamp stamp;
+	weak_ptr<const RomData> rom;
+};
+
+static mutex s_cacheMutex;
+static map<string, PathEntry> s_byPath;
+static map<pair<uint64_t, size_t>, weak_ptr<const RomData>> s_byHash;
+
+static bool fileStamp(const string& path, FileStamp* stamp) {
+#ifndef _WIN32
+	struct stat st;
+	if (stat(path.c_str(), &st) < 0) {
+		return false;
+	}
+	stamp->size = st.st_size;
+	stamp->mtime = st.st_mtime;
+	return true;
+#else
+	ifstream in(path, ios::binary | ios::ate);
+	if (in.fail()) {
+		return false;
+	}
+	stamp->size = in.tellg();
+	stamp->mtime = 0;
+	return true;
+#endif
+}
+
+RomData::~RomData() {
+#ifndef _WIN32
+	if (m_mapped) {
+		munmap(const_cast<void*>(m_data), m_size);
+	}
+#endif
+}
+
+bool RomData::map(const string& path) {
+#ifndef _WIN32
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+	void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	m_data = data;
+	m_size = st.st_size;
+	m_mapped = true;
+	return true;
+#else
+	(void) path;
+	return false;
+#endif
+}
+
+bool RomData::read(const string& path) {
+	ifstream in(path, ios::binary | ios::ate);
+	if (in.fail()) {
+		return false;
+	}
+	size_t size = in.tellg();
+	if (in.fail()) {
+		return false;
+	}
+	m_buffer.resize(size);
+	in.seekg(0, ios::beg);
+	in.read(m_buffer.data(), size);
+	if (in.fail()) {
+		return false;
+	}
+	m_data = m_buffer.data();
+	m_size = size;
+	return true;
+}
+
+shared_ptr<const RomData> RomData::load(const string& path) {
+	FileStamp stamp;
+	if (!fileStamp(path, &stamp)) {
+		return nullptr;
+	}
+
+	lock_guard<mutex> lock(s_cacheMutex);
+	auto cached = s_byPath.find(path);
+	if (cached != s_byPath.end() && cached->second.stamp == stamp) {
+		shared_ptr<const RomData> rom = cached->second.rom.lock();
+		if (rom) {
+			return rom;
+		}
+	}
+
+	shared_ptr<RomData> rom(new RomData);
+	if (!rom->map(path) && !rom->read(path)) {
+		return nullptr;
+	}
+	rom->m_hash = fnv1a(rom->m_data, rom->m_size);
+
+	// Share an existing image of the same contents, dropping the new one
+	auto key = make_pair(rom->m_hash, rom->m_size);
+	shared_ptr<const RomData> shared = s_byHash[key].lock();
+	if (!shared || memcmp(shared->data(), rom->data(), rom->size())) {
+		shared = rom;
+		s_byHash[key] = shared;
+	}
+	s_byPath[path] = PathEntry{ stamp, shared };
+	return shared;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Retro {
+
+/* A read-only ROM image, memory-mapped where the platform allows it.
+ *
+ * Images are shared through a process-wide cache keyed by path, which is
+ * revalidated against the file's size and modification time, and by content
+ * hash, so copies of the same ROM under different paths share one mapping too.
+ * The cache only holds weak references: an image is unmapped once the last
+ * emulator using it lets go.
+ */
+class RomData {
+public:
+	~RomData();
+	RomData(const RomData&) = delete;
+
+	static std::shared_ptr<const RomData> load(const std::string& path);
+
+	const void* data() const { return m_data; }
+	size_t size() const { return m_size; }
+	uint64_t hash() const { return m_hash; }
+
+private:
+	RomData() = default;
+	bool map(const std::string& path);
+	bool read(const std::string& path);
+
+	const void* m_data = nullptr;
+	size_t m_size = 0;
+	uint64_t m_hash = 0;
+	bool m_mapped = false;
+
+	// Fallback storage when the file can't be mapped
+	std::vector<char> m_buffer;
+};
+}
@@ -1,16 +1,115 @@
 #include "script-lua.h"
 
 #include "data.h"
+#include "perf.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <mutex>
 
 using namespace Retro;
 using namespace std;
 
+// Compiled scripts, shared by every context in the process
+struct CompiledChunk {
+	string source;
+	string bytecode;
+};
+
+static mutex s_chunkMutex;
+static unordered_map<string, CompiledChunk> s_chunks;
+
+#ifdef LUAJIT_VERSION
+// Builds closures that read variables straight out of emulator memory through
+// FFI pointers, so traces compile them down to plain loads. Called with the
+// ffi module, bit.band and the C fallback for everything it can't handle.
+static const char s_fastDataSource[] = R"LUA(
+local ffi, band, fallback = ...
+local bytes = ffi.typeof("const uint8_t*")
+
+-- Decoded value of each byte for the BCD representations
+local digits = { d = ffi.new("uint8_t[256]"), n = ffi.new("uint8_t[256]") }
+for b = 0, 255 do
+	digits.d[b] = b % 16 % 10 + math.floor(b / 16) % 10 * 10
+	digits.n[b] = b % 16 % 10
+end
+
+-- One generated factory per shape, so each getter is straight-line code
+local factories = {}
+local function factory(width, bcd, signed, masked)
+	local key = width .. (bcd and "d" or "") .. (signed and "i" or "") .. (masked and "m" or "")
+	if factories[key] then
+		return factories[key]
+	end
+	local args = { "p", "d", "band", "mask", "half", "full" }
+	local terms = {}
+	for i = 1, width do
+		args[#args + 1] = "o" .. i
+		args[#args + 1] = "s" .. i
+		terms[i] = (bcd and "d[p[o%d]]" or "p[o%d]"):format(i) .. " * s" .. i
+	end
+	local source = {
+		"local " .. table.concat(args, ", ") .. " = ...",
+		"return function()",
+		"local v = " .. table.concat(terms, " + "),
+		signed and "if v >= half then v = v - full end" or "",
+		masked and "return band(v, mask)" or "return v",
+		"end"
+	}
+	factories[key] = assert(loadstring(table.concat(source, "\n"), "=data"))
+	return factories[key]
+end
+
+local M = {}
+
+-- Offsets and weights of each byte follow as (offset, weight) pairs
+function M.variable(ptr, repr, width, mask, ...)
+	local make = factory(width, repr == "d" or repr == "n", repr == "i", mask ~= nil)
+	local full = 2 ^ (8 * width)
+	return make(ffi.cast(bytes, ptr), digits[repr], band, mask, full / 2, full, ...)
+end
+
+function M.index(getters, blocks, perm, width)
+	for _, block in ipairs(blocks) do
+		block.ptr = ffi.cast(bytes, block.ptr)
+	end
+	return function(t, k)
+		local get = getters[k]
+		if get then
+			return get()
+		end
+		if type(k) == "number" and k >= 0 and k % 1 == 0 then
+			for i = 1, #blocks do
+				local block = blocks[i]
+				local offset = k - block.base
+				if offset >= 0 and offset < block.size then
+					local edge = offset % width
+					offset = offset - edge + perm[edge]
+					if offset < block.size then
+						return block.ptr[offset]
+					end
+					break
+				end
+			end
+		end
+		return fallback(t, k)
+	end
+end
+
+return M
+)LUA";
+#endif
+
 shared_ptr<ScriptContext> ScriptLua::create() {
 	return make_shared<ScriptLua>();
 }
 
 ScriptLua::~ScriptLua() {
 	if (m_L) {
+		clearHandles();
+		luaL_unref(m_L, LUA_REGISTRYINDEX, m_fastData);
+		luaL_unref(m_L, LUA_REGISTRYINDEX, m_dataTable);
 		lua_close(m_L);
 	}
 }
@@ -101,6 +200,11 @@ static int _noop(lua_State*) {
 	return 0;
 }
 
+static int _writeChunk(lua_State*, const void* data, size_t size, void* chunk) {
+	static_cast<string*>(chunk)->append(static_cast<const char*>(data), size);
+	return 0;
+}
+
 void ScriptLua::setData(GameData* data) {
 	ScriptContext::setData(data);
 
@@ -119,6 +223,12 @@ void ScriptLua::setData(GameData* data) {
 	lua_setfield(m_L, -2, "__newindex");
 
 	lua_setmetatable(m_L, -2);
+
+	lua_pushvalue(m_L, -1);
+	luaL_unref(m_L, LUA_REGISTRYINDEX, m_dataTable);
+	m_dataTable = luaL_ref(m_L, LUA_REGISTRYINDEX);
+	m_layoutValid = false;
+
 	lua_setglobal(m_L, "data");
 };
 
@@ -153,21 +263,250 @@ bool ScriptLua::init() {
 	luaopen_string(m_L);
 	luaopen_math(m_L);
 
+#ifdef LUAJIT_VERSION
+	// The JIT, ffi and bit libraries only back the data table; none of them
+	// are visible to scripts
+	lua_pushcfunction(m_L, luaopen_jit);
+	lua_call(m_L, 0, 0);
+	lua_pushcfunction(m_L, luaopen_ffi);
+	lua_call(m_L, 0, 1);
+	lua_pushcfunction(m_L, luaopen_bit);
+	lua_call(m_L, 0, 1);
+	lua_getfield(m_L, -1, "band");
+	lua_remove(m_L, -2);
+	lua_pushcfunction(m_L, _getData);
+	if (luaL_loadbuffer(m_L, s_fastDataSource, sizeof(s_fastDataSource) - 1, "=data") == 0) {
+		lua_insert(m_L, -4);
+		if (lua_pcall(m_L, 3, 1, 0) == 0) {
+			m_fastData = luaL_ref(m_L, LUA_REGISTRYINDEX);
+		} else {
+			lua_pop(m_L, 1);
+		}
+	} else {
+		lua_pop(m_L, 4);
+	}
+	lua_pushnil(m_L);
+	lua_setglobal(m_L, "jit");
+	lua_pushnil(m_L);
+	lua_setglobal(m_L, "bit");
+#endif
+
 	vector<string> functions = listFunctions();
 	m_blacklist = { functions.begin(), functions.end() };
 	return true;
 }
 
 bool ScriptLua::load(const string& filename) {
-	return luaL_dofile(m_L, filename.c_str()) == 0;
+	ifstream file(filename, ios::binary);
+	if (!file) {
+		return false;
+	}
+	string source{ istreambuf_iterator<char>(file), istreambuf_iterator<char>() };
+	if (source.size() && source[0] == '#') {
+		// Skip a shebang line like luaL_loadfile does, keeping line numbers
+		source.erase(0, source.find('\n'));
+	}
+	string chunkName = "@" + filename;
+
+	string bytecode;
+	{
+		lock_guard<mutex> lock(s_chunkMutex);
+		const auto& cached = s_chunks.find(filename);
+		if (cached != s_chunks.end() && cached->second.source == source) {
+			bytecode = cached->second.bytecode;
+		}
+	}
+
+	if (bytecode.size()) {
+		if (luaL_loadbuffer(m_L, bytecode.data(), bytecode.size(), chunkName.c_str())) {
+			lua_pop(m_L, 1);
+			return false;
+		}
+	} else {
+		if (luaL_loadbuffer(m_L, source.data(), source.size(), chunkName.c_str())) {
+			lua_pop(m_L, 1);
+			return false;
+		}
+		lua_dump(m_L, _writeChunk, &bytecode);
+		lock_guard<mutex> lock(s_chunkMutex);
+		s_chunks[filename] = CompiledChunk{ move(source), move(bytecode) };
+	}
+
+	clearHandles();
+	if (lua_pcall(m_L, 0, 0, 0)) {
+		lua_pop(m_L, 1);
+		return false;
+	}
+	return true;
 }
 
 bool ScriptLua::loadString(const string& script) {
+	clearHandles();
 	return luaL_dostring(m_L, script.c_str()) == 0;
 }
 
 Variant ScriptLua::callFunction(const string& funcName) {
+	PerfTimer timer(PerfStage::SCRIPT_CALL);
+	syncData();
+	lua_getglobal(m_L, funcName.c_str());
+	return callTop();
+}
+
+int ScriptLua::functionHandle(const string& funcName) {
+	const auto& found = m_handles.find(funcName);
+	if (found != m_handles.end()) {
+		return found->second;
+	}
 	lua_getglobal(m_L, funcName.c_str());
+	if (!lua_isfunction(m_L, -1)) {
+		lua_pop(m_L, 1);
+		return NO_FUNCTION;
+	}
+	int handle = luaL_ref(m_L, LUA_REGISTRYINDEX);
+	m_handles[funcName] = handle;
+	return handle;
+}
+
+Variant ScriptLua::callFunction(int handle) {
+	PerfTimer timer(PerfStage::SCRIPT_CALL);
+	syncData();
+	lua_rawgeti(m_L, LUA_REGISTRYINDEX, handle);
+	return callTop();
+}
+
+void ScriptLua::clearHandles() {
+	for (const auto& handle : m_handles) {
+		luaL_unref(m_L, LUA_REGISTRYINDEX, handle.second);
+	}
+	m_handles.clear();
+}
+
+void ScriptLua::syncData() {
+#ifdef LUAJIT_VERSION
+	if (m_fastData == LUA_NOREF || m_dataTable == LUA_NOREF) {
+		return;
+	}
+	const GameData* gameData = data();
+	const AddressSpace& mem = gameData->addressSpace();
+	// Compare in place, this runs before every reward and done call
+	bool sameLayout = m_layoutValid && mem.blocks().size() == m_layout.size();
+	if (sameLayout) {
+		size_t i = 0;
+		for (const auto& block : mem.blocks()) {
+			const auto& known = m_layout[i++];
+			if (get<0>(known) != block.first || get<1>(known) != block.second.size() || get<2>(known) != block.second.offset(0)) {
+				sameLayout = false;
+				break;
+			}
+		}
+	}
+	if (sameLayout && m_overlayWidth == mem.overlay().width && m_varsRevision == gameData->variablesRevision()) {
+		return;
+	}
+	m_layout.clear();
+	for (const auto& block : mem.blocks()) {
+		m_layout.emplace_back(block.first, block.second.size(), block.second.offset(0));
+	}
+	m_overlayWidth = mem.overlay().width;
+	m_varsRevision = gameData->variablesRevision();
+	m_layoutValid = true;
+
+	// Where each byte of an overlay word really lives
+	size_t width = m_overlayWidth;
+	uint8_t identity[16];
+	uint8_t perm[16]{};
+	for (size_t i = 0; i < width && i < sizeof(identity); ++i) {
+		identity[i] = i;
+	}
+	if (width > 1 && width <= sizeof(identity)) {
+		mem.overlay().parse(identity, 0, perm, width);
+	} else {
+		width = 1;
+	}
+
+	lua_rawgeti(m_L, LUA_REGISTRYINDEX, m_dataTable);
+	lua_rawgeti(m_L, LUA_REGISTRYINDEX, m_fastData);
+	int module = lua_gettop(m_L);
+	lua_getfield(m_L, module, "index");
+
+	lua_newtable(m_L);
+	for (const auto& var : gameData->listVariables()) {
+		const DataType& type = var.second.type;
+		if (!type.width || type.width > 4 || (var.second.mask != UINT64_MAX && var.second.mask >= 0x80000000)) {
+			continue;
+		}
+		if (gameData->isCustomValue(var.first)) {
+			continue;
+		}
+		const auto& block = find_if(m_layout.begin(), m_layout.end(), [&var](const tuple<size_t, size_t, const void*>& b) {
+			return var.second.address >= get<0>(b) && var.second.address - get<0>(b) < get<1>(b);
+		});
+		if (block == m_layout.end()) {
+			continue;
+		}
+		size_t offsets[4];
+		bool inside = true;
+		for (size_t i = 0; i < type.width; ++i) {
+			size_t offset = var.second.address - get<0>(*block) + i;
+			offsets[i] = offset - offset % width + perm[offset % width];
+			inside = inside && offsets[i] < get<1>(*block);
+		}
+		if (!inside) {
+			continue;
+		}
+
+		lua_getfield(m_L, module, "variable");
+		lua_pushlightuserdata(m_L, const_cast<void*>(get<2>(*block)));
+		char repr = static_cast<char>(type.repr);
+		lua_pushlstring(m_L, &repr, 1);
+		lua_pushinteger(m_L, type.width);
+		if (var.second.mask != UINT64_MAX) {
+			lua_pushnumber(m_L, var.second.mask);
+		} else {
+			lua_pushnil(m_L);
+		}
+		for (size_t i = 0; i < type.width; ++i) {
+			// Probe the weight of each byte from the decoder itself
+			uint8_t unit[8]{};
+			unit[i] = 1;
+			lua_pushnumber(m_L, offsets[i]);
+			lua_pushnumber(m_L, type.decode(unit));
+		}
+		lua_call(m_L, 4 + type.width * 2, 1);
+		lua_setfield(m_L, -2, var.first.c_str());
+	}
+
+	lua_createtable(m_L, m_layout.size(), 0);
+	for (size_t i = 0; i < m_layout.size(); ++i) {
+		lua_createtable(m_L, 0, 3);
+		lua_pushnumber(m_L, get<0>(m_layout[i]));
+		lua_setfield(m_L, -2, "base");
+		lua_pushnumber(m_L, get<1>(m_layout[i]));
+		lua_setfield(m_L, -2, "size");
+		lua_pushlightuserdata(m_L, const_cast<void*>(get<2>(m_layout[i])));
+		lua_setfield(m_L, -2, "ptr");
+		lua_rawseti(m_L, -2, i + 1);
+	}
+
+	lua_createtable(m_L, width, 0);
+	for (size_t i = 0; i < width; ++i) {
+		lua_pushinteger(m_L, perm[i]);
+		lua_rawseti(m_L, -2, i);
+	}
+	lua_pushinteger(m_L, width);
+	lua_call(m_L, 4, 1);
+
+	lua_createtable(m_L, 0, 2);
+	lua_insert(m_L, -2);
+	lua_setfield(m_L, -2, "__index");
+	lua_pushcfunction(m_L, _setData);
+	lua_setfield(m_L, -2, "__newindex");
+	lua_setmetatable(m_L, module - 1);
+	lua_pop(m_L, 2);
+#endif
+}
+
+Variant ScriptLua::callTop() {
 	int status = lua_pcall(m_L, 0, 1, 0);
 	if (status != 0) {
 		string error = string("Lua call failed: ") + lua_tostring(m_L, -1);
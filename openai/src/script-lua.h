@@ -2,7 +2,10 @@
 
 #include "script.h"
 
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <lua.hpp>
 
@@ -22,8 +25,25 @@ public:
 	Variant callFunction(const std::string&) override;
 	std::vector<std::string> listFunctions() override;
 
+	int functionHandle(const std::string&) override;
+	Variant callFunction(int handle) override;
+
 private:
+	void clearHandles();
+	Variant callTop();
+	void syncData();
+
 	lua_State* m_L = nullptr;
 	std::unordered_set<std::string> m_blacklist;
+	std::unordered_map<std::string, int> m_handles;
+
+	// Direct reads of the data table through LuaJIT's FFI, rebuilt whenever
+	// the memory layout or the variable definitions change
+	int m_fastData = LUA_NOREF;
+	int m_dataTable = LUA_NOREF;
+	std::vector<std::tuple<size_t, size_t, const void*>> m_layout;
+	size_t m_overlayWidth = 0;
+	uint64_t m_varsRevision = 0;
+	bool m_layoutValid = false;
 };
 }
@@ -11,11 +11,17 @@ namespace Retro {
 
 class GameData;
 class Scenario;
+
+/* An interpreter for one scripting language. Every Scenario owns its own
+ * contexts, so separate environments never share interpreter state.
+ */
 class ScriptContext {
 public:
-	static std::shared_ptr<ScriptContext> get(const std::string& type);
-	static std::vector<std::string> listContexts();
-	static void reset();
+	static const int NO_FUNCTION = -1;
+
+	virtual ~ScriptContext() = default;
+
+	static std::shared_ptr<ScriptContext> create(const std::string& type);
 
 	virtual void setData(GameData*);
 	virtual void setScenario(const Scenario*);
@@ -26,6 +32,11 @@ public:
 	virtual Variant callFunction(const std::string&) = 0;
 	virtual std::vector<std::string> listFunctions() = 0;
 
+	// Resolves a function once for repeated calls, or returns NO_FUNCTION.
+	// Handles are invalidated by loading another script.
+	virtual int functionHandle(const std::string&) = 0;
+	virtual Variant callFunction(int handle) = 0;
+
 protected:
 	GameData* data();
 	const Scenario* scenario();
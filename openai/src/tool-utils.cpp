@@ -0,0 +1,63 @@
+#include "tool-utils.h"
+
+#include "coreinfo.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+namespace Retro {
+
+double elapsedUs(ToolClock::time_point start) {
+	return chrono::duration<double, micro>(ToolClock::now() - start).count();
+}
+
+bool hasSuffix(const string& name, const string& suffix) {
+	return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+vector<string> listDirectory(const string& path, const string& suffix) {
+	vector<string> files;
+	DIR* dir = opendir(path.c_str());
+	if (!dir) {
+		return files;
+	}
+	while (struct dirent* entry = readdir(dir)) {
+		string name = entry->d_name;
+		if (name[0] == '.') {
+			continue;
+		}
+		if (!hasSuffix(name, suffix)) {
+			continue;
+		}
+		files.emplace_back(path + "/" + name);
+	}
+	closedir(dir);
+	sort(files.begin(), files.end());
+	return files;
+}
+
+bool loadCores(const string& coreHint, const string& coreInfoDir) {
+	bool loaded = false;
+	vector<string> directories{ corePath(coreHint) };
+	if (!coreInfoDir.empty()) {
+		directories.emplace_back(coreInfoDir);
+	}
+	for (const auto& directory : directories) {
+		for (const auto& path : listDirectory(directory, ".json")) {
+			ifstream file(path);
+			stringstream contents;
+			contents << file.rdbuf();
+			loaded |= loadCoreInfo(contents.str());
+		}
+		if (loaded) {
+			break;
+		}
+	}
+	return loaded;
+}
+}
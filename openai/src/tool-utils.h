@@ -0,0 +1,25 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace Retro {
+
+/* Helpers shared by the command line tools (retro-bench, retro-replay). They
+ * are not part of retro-base since they assume a POSIX file system.
+ */
+
+using ToolClock = std::chrono::steady_clock;
+
+double elapsedUs(ToolClock::time_point start);
+
+bool hasSuffix(const std::string& name, const std::string& suffix);
+
+// Sorted paths of the entries in a directory, skipping hidden ones
+std::vector<std::string> listDirectory(const std::string& path, const std::string& suffix = {});
+
+// Load the core descriptions next to the cores found from the hint, falling
+// back to coreInfoDir if there are none
+bool loadCores(const std::string& coreHint, const std::string& coreInfoDir = {});
+}
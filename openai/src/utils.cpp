@@ -40,6 +40,15 @@ int64_t calculate(Operation op, int64_t reference, int64_t value) {
 	return 0;
 }
 
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
 string drillUp(const vector<string>& targets, const string& fail, const string& hint) {
 	char rpath[PATH_MAX];
 	string path(".");
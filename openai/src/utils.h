@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -23,5 +25,8 @@ enum class Operation {
 
 int64_t calculate(Operation op, int64_t reference, int64_t value);
 
+// 64-bit FNV-1a, pass the previous result as hash to continue over more data
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xCBF29CE484222325ULL);
+
 std::string drillUp(const std::vector<std::string>& targets, const std::string& fail = {}, const std::string& hint = ".");
 }
@@ -38,6 +38,10 @@ bool RetroEngine::Initialize()
 
 void RetroEngine::Deinitialize()
 {
+#ifdef RETRO_ENGINE_CORE
+  UnloadGame();
+#endif
+
   DeinitializeWebGL();
 }
 
@@ -74,13 +78,82 @@ bool RetroEngine::InitializeWebGL()
   // Clear the color buffer
   glClear(GL_COLOR_BUFFER_BIT);
 
+  if (!m_frameRenderer.Initialize())
+    throw std::runtime_error("Failed to initialize frame renderer");
+
   return true;
 }
 
+void RetroEngine::UploadFrame(
+    uintptr_t data, unsigned int width, unsigned int height, size_t pitch, PixelFormat format)
+{
+  if (m_webGLContext <= 0)
+    return;
+
+  m_frameRenderer.UploadFrame(reinterpret_cast<const void*>(data), width, height, pitch, format);
+}
+
+void RetroEngine::Render()
+{
+  if (m_webGLContext <= 0)
+    return;
+
+#ifdef RETRO_ENGINE_CORE
+  FrameQueue& frames = m_emulatorThread.Frames();
+  if (const VideoFrame* frame = frames.AcquireLatest())
+  {
+    m_frameRenderer.UploadFrame(frame->data.data(), frame->width, frame->height, frame->pitch,
+                                frame->format);
+    frames.Release();
+  }
+#endif
+
+  int width = 0;
+  int height = 0;
+  emscripten_get_canvas_element_size(CANVAS_ID, &width, &height);
+
+  m_frameRenderer.Render(width, height);
+}
+
+#ifdef RETRO_ENGINE_CORE
+bool RetroEngine::LoadGame(const std::string& romPath)
+{
+  UnloadGame();
+
+  return m_emulatorThread.Start(romPath);
+}
+
+void RetroEngine::UnloadGame()
+{
+  m_emulatorThread.Stop();
+}
+
+void RetroEngine::SetButton(unsigned int port, unsigned int button, bool pressed)
+{
+  m_emulatorThread.SetButton(port, button, pressed);
+}
+
+AudioRingInfo RetroEngine::GetAudioRing()
+{
+  SpscRingBuffer<int16_t>& audio = m_emulatorThread.Audio();
+
+  AudioRingInfo ring;
+  ring.samples = reinterpret_cast<uintptr_t>(audio.Data());
+  ring.capacity = audio.Capacity();
+  ring.readIndex = reinterpret_cast<uintptr_t>(&audio.ReadIndex());
+  ring.writeIndex = reinterpret_cast<uintptr_t>(&audio.WriteIndex());
+  ring.sampleRate = reinterpret_cast<uintptr_t>(&m_emulatorThread.AudioSampleRate());
+
+  return ring;
+}
+#endif
+
 void RetroEngine::DeinitializeWebGL()
 {
   if (m_webGLContext > 0)
   {
+    m_frameRenderer.Deinitialize();
+
     EMSCRIPTEN_RESULT result = emscripten_webgl_destroy_context(m_webGLContext);
     if (result != EMSCRIPTEN_RESULT_SUCCESS)
       std::cerr << "Failed to destroy WebGL context (result=" << result << ")" << std::endl;
@@ -8,8 +8,43 @@
 
 #pragma once
 
+#include "video/frame_renderer.hpp"
+
+#ifdef RETRO_ENGINE_CORE
+#include "emulator/emulator_thread.hpp"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
 #include <emscripten/html5.h>
 
+#ifdef RETRO_ENGINE_CORE
+/*!
+ * \brief Location of the audio ring buffer in the WASM heap
+ *
+ * An AudioWorklet maps these onto the shared WebAssembly memory and consumes
+ * the samples produced by the emulation thread.
+ */
+struct AudioRingInfo
+{
+  // Interleaved stereo int16_t samples
+  uintptr_t samples;
+
+  // Number of samples in the ring, a power of two
+  size_t capacity;
+
+  // Free-running size_t sample counts, only the read index is advanced by
+  // the consumer
+  uintptr_t readIndex;
+  uintptr_t writeIndex;
+
+  // uint32_t sample rate in Hz, 0 while no game is running
+  uintptr_t sampleRate;
+};
+#endif
+
 class RetroEngine
 {
 public:
@@ -28,9 +63,62 @@ public:
    */
   void Deinitialize();
 
+  /*!
+   * \brief Upload an emulator frame in the core's native pixel format
+   *
+   * \param data Address of the frame's first pixel in the WASM heap
+   * \param width The frame width, in pixels
+   * \param height The frame height, in pixels
+   * \param pitch The distance between rows, in bytes
+   * \param format The pixel format reported by the core
+   */
+  void UploadFrame(
+      uintptr_t data, unsigned int width, unsigned int height, size_t pitch, PixelFormat format);
+
+  /*!
+   * \brief Draw the most recently uploaded frame to the canvas
+   *
+   * While a game is running, the newest frame from the emulation thread is
+   * uploaded first.
+   */
+  void Render();
+
+#ifdef RETRO_ENGINE_CORE
+  /*!
+   * \brief Start emulating a game on the emulation thread
+   *
+   * \param romPath Path of the ROM in the Emscripten file system
+   *
+   * \return true if emulation was started, false otherwise
+   */
+  bool LoadGame(const std::string& romPath);
+
+  /*!
+   * \brief Stop emulating the current game
+   */
+  void UnloadGame();
+
+  /*!
+   * \brief Press or release a button on a controller port
+   */
+  void SetButton(unsigned int port, unsigned int button, bool pressed);
+
+  /*!
+   * \brief Get the audio ring buffer to attach an AudioWorklet to
+   *
+   * The ring outlives games, so this only needs to be called once.
+   */
+  AudioRingInfo GetAudioRing();
+#endif
+
 private:
   bool InitializeWebGL();
   void DeinitializeWebGL();
 
   EMSCRIPTEN_WEBGL_CONTEXT_HANDLE m_webGLContext;
+  FrameRenderer m_frameRenderer;
+
+#ifdef RETRO_ENGINE_CORE
+  EmulatorThread m_emulatorThread;
+#endif
 };
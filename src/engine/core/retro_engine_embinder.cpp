@@ -12,8 +12,29 @@
 
 EMSCRIPTEN_BINDINGS(engine)
 {
-  emscripten::class_<RetroEngine>("RetroEngine")
-      .constructor<>()
+  emscripten::enum_<PixelFormat>("PixelFormat")
+      .value("RGB1555", PixelFormat::RGB1555)
+      .value("XRGB8888", PixelFormat::XRGB8888)
+      .value("RGB565", PixelFormat::RGB565);
+
+  emscripten::class_<RetroEngine> engine("RetroEngine");
+  engine.constructor<>()
       .function("initialize", &RetroEngine::Initialize)
-      .function("deinitialize", &RetroEngine::Deinitialize);
+      .function("deinitialize", &RetroEngine::Deinitialize)
+      .function("uploadFrame", &RetroEngine::UploadFrame)
+      .function("render", &RetroEngine::Render);
+
+#ifdef RETRO_ENGINE_CORE
+  emscripten::value_object<AudioRingInfo>("AudioRingInfo")
+      .field("samples", &AudioRingInfo::samples)
+      .field("capacity", &AudioRingInfo::capacity)
+      .field("readIndex", &AudioRingInfo::readIndex)
+      .field("writeIndex", &AudioRingInfo::writeIndex)
+      .field("sampleRate", &AudioRingInfo::sampleRate);
+
+  engine.function("loadGame", &RetroEngine::LoadGame)
+      .function("unloadGame", &RetroEngine::UnloadGame)
+      .function("setButton", &RetroEngine::SetButton)
+      .function("getAudioRing", &RetroEngine::GetAudioRing);
+#endif
 }
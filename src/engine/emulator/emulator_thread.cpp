@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+#include "emulator_thread.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <coreinfo.h>
+
+namespace
+{
+// Core description, embedded into the Emscripten file system at link time
+constexpr const char* CORE_INFO_PATH = "/retro/core.json";
+
+// Interleaved stereo samples, about 170 ms at 48 kHz
+constexpr size_t AUDIO_BUFFER_SAMPLES = 16384;
+
+// Resynchronize instead of fast-forwarding when emulation falls this far behind
+constexpr int MAX_FRAMES_BEHIND = 4;
+
+PixelFormat GetPixelFormat(int imageDepth)
+{
+  switch (imageDepth)
+  {
+    case 16:
+      return PixelFormat::RGB565;
+    case 32:
+      return PixelFormat::XRGB8888;
+    default:
+      return PixelFormat::RGB1555;
+  }
+}
+} // namespace
+
+EmulatorThread::EmulatorThread() : m_audio(AUDIO_BUFFER_SAMPLES)
+{
+}
+
+EmulatorThread::~EmulatorThread()
+{
+  Stop();
+}
+
+bool EmulatorThread::Start(const std::string& romPath)
+{
+  if (m_thread.joinable())
+    return false;
+
+  for (std::atomic<uint32_t>& buttons : m_buttons)
+    buttons.store(0, std::memory_order_relaxed);
+
+  m_state.store(State::LOADING, std::memory_order_release);
+  m_thread = std::thread(&EmulatorThread::Run, this, romPath);
+
+  return true;
+}
+
+void EmulatorThread::Stop()
+{
+  if (!m_thread.joinable())
+    return;
+
+  m_stopRequested.store(true, std::memory_order_release);
+  m_thread.join();
+  m_stopRequested.store(false, std::memory_order_relaxed);
+
+  m_audioSampleRate.store(0, std::memory_order_relaxed);
+  m_state.store(State::STOPPED, std::memory_order_release);
+}
+
+void EmulatorThread::SetButton(unsigned int port, unsigned int button, bool pressed)
+{
+  if (port >= m_buttons.size() || button >= Retro::N_BUTTONS)
+    return;
+
+  if (pressed)
+    m_buttons[port].fetch_or(1u << button, std::memory_order_relaxed);
+  else
+    m_buttons[port].fetch_and(~(1u << button), std::memory_order_relaxed);
+}
+
+void EmulatorThread::Run(std::string romPath)
+{
+  // The core keeps global state, so it is only ever touched from this thread
+  Retro::Emulator emulator;
+
+  std::ifstream coreInfo(CORE_INFO_PATH);
+  std::ostringstream coreInfoJson;
+  coreInfoJson << coreInfo.rdbuf();
+
+  if (!Retro::loadCoreInfo(coreInfoJson.str()) || !emulator.loadRom(romPath))
+  {
+    m_state.store(State::FAILED, std::memory_order_release);
+    return;
+  }
+
+  // The consumer resamples with dynamic rate control, which absorbs the rounding
+  m_audioSampleRate.store(std::lround(emulator.getAudioRate()), std::memory_order_relaxed);
+  m_state.store(State::RUNNING, std::memory_order_release);
+
+  const auto frameDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / emulator.getFrameRate()));
+  auto nextFrame = std::chrono::steady_clock::now();
+
+  while (!m_stopRequested.load(std::memory_order_acquire))
+  {
+    for (unsigned int port = 0; port < m_buttons.size(); ++port)
+    {
+      const uint32_t buttons = m_buttons[port].load(std::memory_order_relaxed);
+      for (int button = 0; button < Retro::N_BUTTONS; ++button)
+        emulator.setKey(port, button, (buttons >> button) & 1);
+    }
+
+    emulator.run();
+
+    PublishFrame(emulator);
+    m_audio.Write(emulator.getAudioData(), emulator.getAudioSamples() * 2);
+
+    nextFrame += frameDuration;
+    const auto now = std::chrono::steady_clock::now();
+    if (now - nextFrame > MAX_FRAMES_BEHIND * frameDuration)
+      nextFrame = now;
+    else
+      std::this_thread::sleep_until(nextFrame);
+  }
+}
+
+void EmulatorThread::PublishFrame(Retro::Emulator& emulator)
+{
+  const uint8_t* source = static_cast<const uint8_t*>(emulator.getImageData());
+  if (source == nullptr)
+    return;
+
+  // The renderer is behind, so this frame would never be shown
+  VideoFrame* frame = m_frames.BeginWrite();
+  if (frame == nullptr)
+    return;
+
+  const PixelFormat format = GetPixelFormat(emulator.getImageDepth());
+  const unsigned int width = emulator.getImageWidth();
+  const unsigned int height = emulator.getImageHeight();
+  const size_t pitch = emulator.getImagePitch();
+  const size_t rowSize = width * (format == PixelFormat::XRGB8888 ? 4 : 2);
+
+  // The core reuses its framebuffer, so pack the rows into the slot
+  frame->data.resize(rowSize * height);
+  for (unsigned int y = 0; y < height; ++y)
+    std::memcpy(&frame->data[y * rowSize], source + y * pitch, rowSize);
+
+  frame->width = width;
+  frame->height = height;
+  frame->pitch = rowSize;
+  frame->format = format;
+
+  m_frames.EndWrite();
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+#pragma once
+
+#include "utils/spsc_ring_buffer.hpp"
+#include "video/frame_queue.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <emulator.h>
+
+/*!
+ * \brief Runs the statically linked libretro core on a dedicated thread
+ *
+ * With Emscripten pthreads the thread is a Web Worker, so emulation never
+ * blocks the main thread. Frames and audio are handed to the main thread
+ * through lock-free ring buffers.
+ */
+class EmulatorThread
+{
+public:
+  enum class State
+  {
+    STOPPED,
+    LOADING,
+    RUNNING,
+    FAILED,
+  };
+
+  EmulatorThread();
+  ~EmulatorThread();
+
+  /*!
+   * \brief Start emulating a ROM
+   *
+   * Returns immediately. The ROM is loaded on the emulation thread, poll
+   * GetState() to learn whether it succeeded.
+   *
+   * \param romPath Path of the ROM in the Emscripten file system
+   *
+   * \return true if the thread was started, false if it was already running
+   */
+  bool Start(const std::string& romPath);
+
+  /*!
+   * \brief Stop emulating and join the thread
+   */
+  void Stop();
+
+  State GetState() const { return m_state.load(std::memory_order_acquire); }
+
+  /*!
+   * \brief Press or release a button, applied before the next frame
+   */
+  void SetButton(unsigned int port, unsigned int button, bool pressed);
+
+  FrameQueue& Frames() { return m_frames; }
+  SpscRingBuffer<int16_t>& Audio() { return m_audio; }
+
+  /*!
+   * \brief Sample rate of Audio() in Hz, rounded, or 0 while no game is running
+   */
+  const std::atomic<uint32_t>& AudioSampleRate() const { return m_audioSampleRate; }
+
+private:
+  void Run(std::string romPath);
+  void PublishFrame(Retro::Emulator& emulator);
+
+  std::thread m_thread;
+  std::atomic<bool> m_stopRequested{false};
+  std::atomic<State> m_state{State::STOPPED};
+
+  // One bit per button, per port
+  std::array<std::atomic<uint32_t>, Retro::MAX_PLAYERS> m_buttons{};
+
+  FrameQueue m_frames;
+  SpscRingBuffer<int16_t> m_audio;
+  std::atomic<uint32_t> m_audioSampleRate{0};
+};
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*!
+ * \brief Lock-free ring buffer for one producer thread and one consumer thread
+ *
+ * The read and write indices count elements since creation and are only
+ * reduced modulo the capacity when indexing, so a full buffer can be told
+ * apart from an empty one without sacrificing a slot.
+ */
+template<typename T>
+class SpscRingBuffer
+{
+public:
+  /*!
+   * \brief Create a ring buffer
+   *
+   * \param capacity The minimum number of elements, rounded up to a power of two
+   */
+  explicit SpscRingBuffer(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity)
+      size <<= 1;
+
+    m_buffer.resize(size);
+    m_mask = size - 1;
+  }
+
+  /*!
+   * \brief Append elements, called from the producer thread
+   *
+   * \return The number of elements written, which is less than count if the
+   *         buffer filled up
+   */
+  size_t Write(const T* data, size_t count)
+  {
+    const size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+    const size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+
+    count = std::min(count, Capacity() - (writeIndex - readIndex));
+    for (size_t i = 0; i < count; ++i)
+      m_buffer[(writeIndex + i) & m_mask] = data[i];
+
+    m_writeIndex.store(writeIndex + count, std::memory_order_release);
+    return count;
+  }
+
+  /*!
+   * \brief Remove elements, called from the consumer thread
+   *
+   * \return The number of elements read, which is less than count if the
+   *         buffer ran empty
+   */
+  size_t Read(T* data, size_t count)
+  {
+    const size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+    const size_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+    count = std::min(count, writeIndex - readIndex);
+    for (size_t i = 0; i < count; ++i)
+      data[i] = m_buffer[(readIndex + i) & m_mask];
+
+    m_readIndex.store(readIndex + count, std::memory_order_release);
+    return count;
+  }
+
+  /*!
+   * \brief Number of elements that can currently be read
+   */
+  size_t Size() const
+  {
+    return m_writeIndex.load(std::memory_order_acquire) -
+           m_readIndex.load(std::memory_order_acquire);
+  }
+
+  size_t Capacity() const { return m_mask + 1; }
+
+  /*!
+   * \brief Raw storage, for a consumer outside of C++
+   *
+   * An AudioWorklet can map these onto the shared WebAssembly memory and
+   * take the place of the consumer thread. Reduce the indices modulo
+   * Capacity() and advance only the read index.
+   */
+  const T* Data() const { return m_buffer.data(); }
+  std::atomic<size_t>& ReadIndex() { return m_readIndex; }
+  const std::atomic<size_t>& WriteIndex() const { return m_writeIndex; }
+
+private:
+  static_assert(std::atomic<size_t>::is_always_lock_free,
+                "The indices must be plain integers in memory");
+
+  std::vector<T> m_buffer;
+  size_t m_mask = 0;
+
+  // Keep the indices on separate cache lines so the threads don't contend
+  alignas(64) std::atomic<size_t> m_readIndex{0};
+  alignas(64) std::atomic<size_t> m_writeIndex{0};
+};
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+#include "frame_queue.hpp"
+
+VideoFrame* FrameQueue::BeginWrite()
+{
+  const size_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+  const size_t readIndex = m_readIndex.load(std::memory_order_acquire);
+
+  if (writeIndex - readIndex >= SLOT_COUNT)
+    return nullptr;
+
+  return &m_slots[writeIndex % SLOT_COUNT];
+}
+
+void FrameQueue::EndWrite()
+{
+  m_writeIndex.fetch_add(1, std::memory_order_release);
+}
+
+const VideoFrame* FrameQueue::AcquireLatest()
+{
+  const size_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+  const size_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+  if (readIndex == writeIndex)
+    return nullptr;
+
+  // Skip stale frames, handing their slots back to the producer
+  const size_t latestIndex = writeIndex - 1;
+  m_readIndex.store(latestIndex, std::memory_order_release);
+
+  return &m_slots[latestIndex % SLOT_COUNT];
+}
+
+void FrameQueue::Release()
+{
+  m_readIndex.fetch_add(1, std::memory_order_release);
+}
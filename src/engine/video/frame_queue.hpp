@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+#pragma once
+
+#include "video/frame_renderer.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*!
+ * \brief A frame copied out of the core's framebuffer
+ */
+struct VideoFrame
+{
+  std::vector<uint8_t> data;
+  unsigned int width = 0;
+  unsigned int height = 0;
+  size_t pitch = 0;
+  PixelFormat format = PixelFormat::RGB565;
+};
+
+/*!
+ * \brief Lock-free ring of frames passed from the emulation thread to the
+ *        render thread
+ *
+ * The producer drops frames while the ring is full. The consumer only ever
+ * wants the newest frame, so acquiring one releases every older frame.
+ */
+class FrameQueue
+{
+public:
+  /*!
+   * \brief Get a slot to fill, called from the producer thread
+   *
+   * \return The slot, or nullptr if the consumer hasn't released enough frames
+   */
+  VideoFrame* BeginWrite();
+
+  /*!
+   * \brief Publish the slot returned by BeginWrite()
+   */
+  void EndWrite();
+
+  /*!
+   * \brief Get the newest published frame, called from the consumer thread
+   *
+   * \return The frame, or nullptr if no new frame was published. A returned
+   *         frame must be given back with Release().
+   */
+  const VideoFrame* AcquireLatest();
+
+  /*!
+   * \brief Give back the frame returned by AcquireLatest()
+   */
+  void Release();
+
+private:
+  static constexpr size_t SLOT_COUNT = 4;
+
+  std::array<VideoFrame, SLOT_COUNT> m_slots;
+
+  alignas(64) std::atomic<size_t> m_readIndex{0};
+  alignas(64) std::atomic<size_t> m_writeIndex{0};
+};
@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+#include "frame_renderer.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+namespace
+{
+// Draws a single triangle covering the viewport, so no vertex buffer is needed
+constexpr const char* VERTEX_SHADER = R"(#version 300 es
+out vec2 v_texCoord;
+
+void main()
+{
+  vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+  v_texCoord = vec2(position.x, 1.0 - position.y);
+  gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// Decodes RGB565 and 0RGB1555 pixels stored in a 16-bit integer texture
+constexpr const char* FRAGMENT_SHADER_16 = R"(#version 300 es
+precision highp float;
+precision highp int;
+precision highp usampler2D;
+
+uniform usampler2D u_frame;
+uniform vec2 u_frameSize;
+uniform int u_format;
+
+in vec2 v_texCoord;
+out vec4 fragColor;
+
+void main()
+{
+  ivec2 texel = ivec2(min(v_texCoord * u_frameSize, u_frameSize - 1.0));
+  uint pixel = texelFetch(u_frame, texel, 0).r;
+
+  vec3 color;
+  if (u_format == 2)
+  {
+    // RGB565
+    color = vec3(float((pixel >> 11u) & 0x1Fu) / 31.0, float((pixel >> 5u) & 0x3Fu) / 63.0,
+                 float(pixel & 0x1Fu) / 31.0);
+  }
+  else
+  {
+    // 0RGB1555
+    color = vec3(float((pixel >> 10u) & 0x1Fu) / 31.0, float((pixel >> 5u) & 0x1Fu) / 31.0,
+                 float(pixel & 0x1Fu) / 31.0);
+  }
+
+  fragColor = vec4(color, 1.0);
+}
+)";
+
+// XRGB8888 is stored as B, G, R, X bytes on little-endian hosts
+constexpr const char* FRAGMENT_SHADER_32 = R"(#version 300 es
+precision highp float;
+
+uniform sampler2D u_frame;
+uniform vec2 u_frameSize;
+
+in vec2 v_texCoord;
+out vec4 fragColor;
+
+void main()
+{
+  ivec2 texel = ivec2(min(v_texCoord * u_frameSize, u_frameSize - 1.0));
+  fragColor = vec4(texelFetch(u_frame, texel, 0).bgr, 1.0);
+}
+)";
+
+bool Is16Bit(PixelFormat format)
+{
+  return format != PixelFormat::XRGB8888;
+}
+} // namespace
+
+FrameRenderer::FrameRenderer() = default;
+
+FrameRenderer::~FrameRenderer()
+{
+  Deinitialize();
+}
+
+bool FrameRenderer::Initialize()
+{
+  if (!CreateProgram(FRAGMENT_SHADER_16, m_program16))
+    return false;
+
+  if (!CreateProgram(FRAGMENT_SHADER_32, m_program32))
+  {
+    Deinitialize();
+    return false;
+  }
+
+  // WebGL2 requires a bound vertex array even when drawing without attributes
+  glGenVertexArrays(1, &m_vertexArray);
+
+  for (FrameTexture& frame : m_frames)
+    glGenTextures(1, &frame.texture);
+
+  return true;
+}
+
+void FrameRenderer::Deinitialize()
+{
+  for (FrameTexture& frame : m_frames)
+  {
+    if (frame.texture != 0)
+      glDeleteTextures(1, &frame.texture);
+    frame = FrameTexture{};
+  }
+
+  if (m_vertexArray != 0)
+  {
+    glDeleteVertexArrays(1, &m_vertexArray);
+    m_vertexArray = 0;
+  }
+
+  for (Program* program : {&m_program16, &m_program32})
+  {
+    if (program->program != 0)
+      glDeleteProgram(program->program);
+    *program = Program{};
+  }
+
+  m_currentFrame = 0;
+  m_hasFrame = false;
+}
+
+void FrameRenderer::UploadFrame(
+    const void* data, unsigned int width, unsigned int height, size_t pitch, PixelFormat format)
+{
+  if (data == nullptr || width == 0 || height == 0)
+    return;
+
+  // Upload into the texture that isn't being displayed, so the upload never
+  // waits on a draw that is still reading the current frame
+  const unsigned int backFrame = m_currentFrame ^ 1;
+  FrameTexture& frame = m_frames[backFrame];
+
+  if (frame.width != width || frame.height != height || frame.format != format)
+    AllocateTexture(frame, width, height, format);
+
+  const GLint bytesPerPixel = Is16Bit(format) ? 2 : 4;
+
+  glBindTexture(GL_TEXTURE_2D, frame.texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, bytesPerPixel);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(pitch) / bytesPerPixel);
+
+  if (Is16Bit(format))
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED_INTEGER, GL_UNSIGNED_SHORT, data);
+  else
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+  m_currentFrame = backFrame;
+  m_hasFrame = true;
+}
+
+void FrameRenderer::Render(int viewportWidth, int viewportHeight)
+{
+  glViewport(0, 0, viewportWidth, viewportHeight);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  if (!m_hasFrame || viewportWidth <= 0 || viewportHeight <= 0)
+    return;
+
+  const FrameTexture& frame = m_frames[m_currentFrame];
+  const Program& program = Is16Bit(frame.format) ? m_program16 : m_program32;
+
+  // Fit the frame to the canvas while keeping its aspect ratio
+  const float scale = std::min(static_cast<float>(viewportWidth) / frame.width,
+                               static_cast<float>(viewportHeight) / frame.height);
+  const int width = static_cast<int>(frame.width * scale);
+  const int height = static_cast<int>(frame.height * scale);
+  glViewport((viewportWidth - width) / 2, (viewportHeight - height) / 2, width, height);
+
+  glUseProgram(program.program);
+  glUniform2f(program.frameSizeLocation, static_cast<float>(frame.width),
+              static_cast<float>(frame.height));
+  if (program.formatLocation >= 0)
+    glUniform1i(program.formatLocation, static_cast<GLint>(frame.format));
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, frame.texture);
+
+  glBindVertexArray(m_vertexArray);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glBindVertexArray(0);
+}
+
+bool FrameRenderer::CreateProgram(const char* fragmentSource, Program& program)
+{
+  const GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, VERTEX_SHADER);
+  if (vertexShader == 0)
+    return false;
+
+  const GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
+  if (fragmentShader == 0)
+  {
+    glDeleteShader(vertexShader);
+    return false;
+  }
+
+  const GLuint handle = glCreateProgram();
+  glAttachShader(handle, vertexShader);
+  glAttachShader(handle, fragmentShader);
+  glLinkProgram(handle);
+
+  // The program keeps the shaders alive for as long as it needs them
+  glDeleteShader(vertexShader);
+  glDeleteShader(fragmentShader);
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(handle, GL_LINK_STATUS, &linked);
+  if (linked != GL_TRUE)
+  {
+    char log[512] = {};
+    glGetProgramInfoLog(handle, sizeof(log), nullptr, log);
+    std::cerr << "Failed to link shader program: " << log << std::endl;
+    glDeleteProgram(handle);
+    return false;
+  }
+
+  program.program = handle;
+  program.frameSizeLocation = glGetUniformLocation(handle, "u_frameSize");
+  program.formatLocation = glGetUniformLocation(handle, "u_format");
+
+  // The frame is always bound to texture unit 0
+  glUseProgram(handle);
+  glUniform1i(glGetUniformLocation(handle, "u_frame"), 0);
+  glUseProgram(0);
+
+  return true;
+}
+
+GLuint FrameRenderer::CompileShader(GLenum type, const char* source)
+{
+  const GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+
+  GLint compiled = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (compiled != GL_TRUE)
+  {
+    char log[512] = {};
+    glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+    std::cerr << "Failed to compile shader: " << log << std::endl;
+    glDeleteShader(shader);
+    return 0;
+  }
+
+  return shader;
+}
+
+void FrameRenderer::AllocateTexture(
+    FrameTexture& frame, unsigned int width, unsigned int height, PixelFormat format)
+{
+  // Immutable storage can't be resized, so replace the texture object
+  glDeleteTextures(1, &frame.texture);
+  glGenTextures(1, &frame.texture);
+
+  glBindTexture(GL_TEXTURE_2D, frame.texture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, Is16Bit(format) ? GL_R16UI : GL_RGBA8, width, height);
+
+  // Integer textures can't be filtered, and texels are fetched directly anyway
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  frame.width = width;
+  frame.height = height;
+  frame.format = format;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <GLES3/gl3.h>
+
+/*!
+ * \brief Pixel formats produced by libretro cores
+ *
+ * The values match libretro's retro_pixel_format so that the format reported
+ * by RETRO_ENVIRONMENT_SET_PIXEL_FORMAT can be passed through unchanged.
+ */
+enum class PixelFormat
+{
+  RGB1555 = 0,
+  XRGB8888 = 1,
+  RGB565 = 2,
+};
+
+/*!
+ * \brief Presents emulator frames with WebGL
+ *
+ * Frames are uploaded in the core's native pixel format into one of two
+ * persistent textures. Pixel format conversion and scaling to the canvas
+ * happen in the fragment shader, so no per-pixel work is done on the CPU.
+ */
+class FrameRenderer
+{
+public:
+  FrameRenderer();
+  ~FrameRenderer();
+
+  /*!
+   * \brief Create the shader programs and textures
+   *
+   * A WebGL2 context must be current.
+   *
+   * \return true if successful, false otherwise
+   */
+  bool Initialize();
+
+  /*!
+   * \brief Release all GL resources
+   */
+  void Deinitialize();
+
+  /*!
+   * \brief Upload a frame into the back texture and make it current
+   *
+   * \param data The frame's first pixel
+   * \param width The frame width, in pixels
+   * \param height The frame height, in pixels
+   * \param pitch The distance between rows, in bytes
+   * \param format The pixel format of the frame
+   */
+  void UploadFrame(
+      const void* data, unsigned int width, unsigned int height, size_t pitch, PixelFormat format);
+
+  /*!
+   * \brief Draw the current frame, preserving its aspect ratio
+   *
+   * \param viewportWidth The width of the drawing buffer
+   * \param viewportHeight The height of the drawing buffer
+   */
+  void Render(int viewportWidth, int viewportHeight);
+
+private:
+  struct FrameTexture
+  {
+    GLuint texture = 0;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    PixelFormat format = PixelFormat::RGB565;
+  };
+
+  struct Program
+  {
+    GLuint program = 0;
+    GLint frameSizeLocation = -1;
+    GLint formatLocation = -1;
+  };
+
+  static bool CreateProgram(const char* fragmentSource, Program& program);
+  static GLuint CompileShader(GLenum type, const char* source);
+  static void AllocateTexture(
+      FrameTexture& frame, unsigned int width, unsigned int height, PixelFormat format);
+
+  std::array<FrameTexture, 2> m_frames;
+  unsigned int m_currentFrame = 0;
+  bool m_hasFrame = false;
+
+  // Program for 16-bit formats, which are decoded from an integer texture
+  Program m_program16;
+
+  // Program for XRGB8888, which is swizzled from an RGBA8 texture
+  Program m_program32;
+
+  GLuint m_vertexArray = 0;
+};
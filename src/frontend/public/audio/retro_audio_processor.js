@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+/* global AudioWorkletProcessor, registerProcessor, sampleRate */
+
+// Samples per frame in the ring, which holds interleaved stereo
+const CHANNELS = 2;
+
+// Amount of audio to keep buffered, in seconds
+const TARGET_LATENCY = 0.05;
+
+// Largest adjustment of the resampling ratio, as a fraction. Half a percent
+// is below what can be heard as a change in pitch.
+const MAX_RATE_DELTA = 0.005;
+
+/*
+ * Plays the audio ring buffer that the emulation thread fills
+ *
+ * The ring lives in the shared WebAssembly memory and this processor is its
+ * consumer. Samples are resampled from the core's rate to the context's rate,
+ * and the ratio is nudged with the buffer fill (dynamic rate control) so that
+ * the small drift between the emulation clock and the audio clock neither
+ * drains nor overflows the ring.
+ */
+class RetroAudioProcessor extends AudioWorkletProcessor {
+  constructor(options) {
+    super();
+
+    const { memory, samples, capacity, readIndex, writeIndex, sourceRate } =
+      options.processorOptions;
+
+    this.samples = new Int16Array(memory, samples, capacity);
+    this.mask = capacity - 1;
+    this.readIndex = new Uint32Array(memory, readIndex, 1);
+    this.writeIndex = new Uint32Array(memory, writeIndex, 1);
+    this.sourceRate = new Uint32Array(memory, sourceRate, 1);
+
+    // Output is interpolated between two source frames
+    this.previous = [0, 0];
+    this.next = [0, 0];
+    this.position = 0;
+  }
+
+  process(inputs, outputs) {
+    const output = outputs[0];
+    const left = output[0];
+    const right = output.length > 1 ? output[1] : null;
+
+    const sourceRate = Atomics.load(this.sourceRate, 0);
+    if (sourceRate === 0) {
+      left.fill(0);
+      if (right) {
+        right.fill(0);
+      }
+      return true;
+    }
+
+    let readIndex = Atomics.load(this.readIndex, 0);
+    const writeIndex = Atomics.load(this.writeIndex, 0);
+
+    // Indices are free-running 32-bit counts
+    let available = ((writeIndex - readIndex) >>> 0) / CHANNELS;
+    const targetFrames = sourceRate * TARGET_LATENCY;
+
+    // Drop audio that piled up while the context was suspended, e.g. in a
+    // background tab, instead of playing it back late
+    if (available > targetFrames * 2) {
+      const skipped = Math.floor(available - targetFrames);
+      readIndex = (readIndex + skipped * CHANNELS) >>> 0;
+      available -= skipped;
+    }
+
+    // Consume faster while above the target fill and slower while below
+    const deviation = Math.max(
+      -1,
+      Math.min(1, (available - targetFrames) / targetFrames),
+    );
+    const step = (sourceRate / sampleRate) * (1 + MAX_RATE_DELTA * deviation);
+
+    for (let i = 0; i < left.length; ++i) {
+      this.position += step;
+      while (this.position >= 1) {
+        this.position -= 1;
+        this.previous[0] = this.next[0];
+        this.previous[1] = this.next[1];
+
+        // On underrun the last frame is held, which is quieter than a click
+        if (available >= 1) {
+          const index = readIndex & this.mask;
+          this.next[0] = this.samples[index] / 32768;
+          this.next[1] = this.samples[(index + 1) & this.mask] / 32768;
+          readIndex = (readIndex + CHANNELS) >>> 0;
+          available -= 1;
+        }
+      }
+
+      const l =
+        this.previous[0] + (this.next[0] - this.previous[0]) * this.position;
+      const r =
+        this.previous[1] + (this.next[1] - this.previous[1]) * this.position;
+
+      if (right) {
+        left[i] = l;
+        right[i] = r;
+      } else {
+        left[i] = (l + r) / 2;
+      }
+    }
+
+    Atomics.store(this.readIndex, 0, readIndex);
+
+    return true;
+  }
+}
+
+registerProcessor("retro-audio-processor", RetroAudioProcessor);
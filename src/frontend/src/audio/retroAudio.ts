@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+// Location of the engine's audio ring buffer in the WASM heap
+interface AudioRingInfo {
+  samples: number;
+  capacity: number;
+  readIndex: number;
+  writeIndex: number;
+  sampleRate: number;
+}
+
+// Engines are only built with audio when a core is linked in
+interface AudioRingSource {
+  getAudioRing(): AudioRingInfo;
+}
+
+// The parts of the Emscripten module needed to reach the shared heap
+interface SharedHeapModule {
+  HEAPU8: Uint8Array;
+}
+
+function hasAudioRing(engine: object): engine is AudioRingSource {
+  return (
+    typeof (engine as Partial<AudioRingSource>).getAudioRing === "function"
+  );
+}
+
+/*
+ * Play the engine's audio through an AudioWorklet
+ *
+ * Returns the audio context, or null if the engine has no audio. Browsers
+ * keep the context suspended until the user interacts with the page, so it
+ * is resumed on the first pointer or key press.
+ */
+async function startRetroAudio(
+  wasmModule: object,
+  engine: object,
+): Promise<AudioContext | null> {
+  if (!hasAudioRing(engine)) {
+    return null;
+  }
+
+  const ring: AudioRingInfo = engine.getAudioRing();
+  const heap: Uint8Array = (wasmModule as SharedHeapModule).HEAPU8;
+
+  const audioContext: AudioContext = new AudioContext({
+    latencyHint: "interactive",
+  });
+  await audioContext.audioWorklet.addModule("/audio/retro_audio_processor.js");
+
+  const node: AudioWorkletNode = new AudioWorkletNode(
+    audioContext,
+    "retro-audio-processor",
+    {
+      numberOfInputs: 0,
+      outputChannelCount: [2],
+      processorOptions: {
+        memory: heap.buffer,
+        samples: ring.samples,
+        capacity: ring.capacity,
+        readIndex: ring.readIndex,
+        writeIndex: ring.writeIndex,
+        sourceRate: ring.sampleRate,
+      },
+    },
+  );
+  node.connect(audioContext.destination);
+
+  const resume = (): void => {
+    audioContext.resume().catch(console.error);
+    window.removeEventListener("pointerdown", resume);
+    window.removeEventListener("keydown", resume);
+  };
+  window.addEventListener("pointerdown", resume);
+  window.addEventListener("keydown", resume);
+
+  return audioContext;
+}
+
+export { startRetroAudio };
@@ -10,10 +10,9 @@ import "./RetroEngineComponent.css";
 
 import React, { useEffect, useRef } from "react";
 
-import RetroEngineModule, {
-  MainModule,
-  RetroEngine,
-} from "../wasm/retro_engine.js";
+import { startRetroAudio } from "../audio/retroAudio";
+import { startRetroGame } from "../game/retroGame";
+import type { MainModule, RetroEngine } from "../wasm/retro_engine.js";
 
 // Allow the TypeScript compiler to recognize the module overrides
 declare module "../wasm/retro_engine.js" {
@@ -21,6 +20,35 @@ declare module "../wasm/retro_engine.js" {
     locateFile?: (path: string) => string;
   }): Promise<MainModule>;
 }
+declare module "../wasm/retro_engine_simd.js" {
+  export default function RetroEngineModule(moduleArg?: {
+    locateFile?: (path: string) => string;
+  }): Promise<MainModule>;
+}
+
+// Smallest module using a SIMD instruction, only valid if the browser
+// supports WebAssembly SIMD
+const SIMD_TEST_MODULE: Uint8Array = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1,
+  8, 0, 65, 0, 253, 15, 253, 98, 11,
+]);
+
+// Load the SIMD build of the engine, falling back to the baseline build
+async function loadRetroEngineModule(moduleOverrides: {
+  locateFile: (file: string) => string;
+}): Promise<MainModule> {
+  if (WebAssembly.validate(SIMD_TEST_MODULE)) {
+    const { default: RetroEngineModule } = await import(
+      "../wasm/retro_engine_simd.js"
+    );
+    return RetroEngineModule(moduleOverrides);
+  }
+
+  const { default: RetroEngineModule } = await import(
+    "../wasm/retro_engine.js"
+  );
+  return RetroEngineModule(moduleOverrides);
+}
 
 const RetroEngineComponent: React.FC = () => {
   // Reference to the canvas element
@@ -50,6 +78,9 @@ const RetroEngineComponent: React.FC = () => {
     }
 
     let engineInstance: RetroEngine | null = null;
+    let audioContext: AudioContext | null = null;
+    let animationFrame: number = 0;
+    let stopGame: (() => void) | null = null;
 
     async function initializeRetroEngine(): Promise<void> {
       // Provide the locateFile function when initializing your WASM module
@@ -60,7 +91,8 @@ const RetroEngineComponent: React.FC = () => {
       };
 
       // Await the promise to resolve to the module instance
-      const wasmModule: MainModule = await RetroEngineModule(moduleOverrides);
+      const wasmModule: MainModule =
+        await loadRetroEngineModule(moduleOverrides);
 
       // Instantiate RetroEngine
       engineInstance = new wasmModule.RetroEngine();
@@ -72,6 +104,28 @@ const RetroEngineComponent: React.FC = () => {
       } else {
         console.error("Failed to initialize RetroEngine");
       }
+
+      // Present the newest frame once per display refresh
+      if (initialized) {
+        const renderFrame = (): void => {
+          engineInstance?.render();
+          animationFrame = window.requestAnimationFrame(renderFrame);
+        };
+        animationFrame = window.requestAnimationFrame(renderFrame);
+      }
+
+      // Play audio produced by the emulation thread, if a core is linked in
+      audioContext = await startRetroAudio(wasmModule, engineInstance);
+
+      // Run ROMs dropped onto the canvas with keyboard input, if a core is
+      // linked in
+      if (containerRef.current) {
+        stopGame = startRetroGame(
+          wasmModule,
+          engineInstance,
+          containerRef.current,
+        );
+      }
     }
 
     // Call the function to initialize and use the RetroEngine
@@ -81,6 +135,15 @@ const RetroEngineComponent: React.FC = () => {
       // Cleanup on component unmount
       window.removeEventListener("resize", updateCanvasSize);
 
+      // Stop the game and its input handlers
+      stopGame?.();
+
+      // Stop presenting before the engine goes away
+      window.cancelAnimationFrame(animationFrame);
+
+      // Stop audio before the heap it reads from goes away
+      audioContext?.close().catch(console.error);
+
       // Deinitialize engine if it has been initialized
       engineInstance?.deinitialize();
       engineInstance?.delete();
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2024 retro.ai
+ * This file is part of retro3 - https://github.com/retroai/retro3
+ *
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ * See the file LICENSE.txt for more information.
+ */
+
+// Engines can only run games when a core is linked in
+interface GameSource {
+  loadGame(romPath: string): boolean;
+  unloadGame(): void;
+  setButton(port: number, button: number, pressed: boolean): void;
+}
+
+// The parts of the Emscripten file system used to hand ROMs to the core
+interface FileSystemModule {
+  FS: {
+    readFile(path: string, opts: { encoding: "utf8" }): string;
+    writeFile(path: string, data: Uint8Array): void;
+  };
+}
+
+// Core description embedded into the engine at link time
+const CORE_INFO_PATH: string = "/retro/core.json";
+
+// Directory ROMs are written to, the core picks a platform by extension
+const ROM_DIRECTORY: string = "/retro";
+
+// Key names used by the keybinds in the core description
+const NAMED_KEYS: Record<string, string> = {
+  TAB: "Tab",
+  ENTER: "Enter",
+  UP: "ArrowUp",
+  DOWN: "ArrowDown",
+  LEFT: "ArrowLeft",
+  RIGHT: "ArrowRight",
+};
+
+function hasGameSource(engine: object): engine is GameSource {
+  return (
+    typeof (engine as Partial<GameSource>).loadGame === "function" &&
+    typeof (engine as Partial<GameSource>).setButton === "function"
+  );
+}
+
+/*
+ * Map KeyboardEvent codes to button indices
+ *
+ * The keybinds of the first platform in the core description are used, so
+ * the keys match those of the desktop integration UI.
+ */
+function readKeybinds(wasmModule: FileSystemModule): Map<string, number> {
+  const keys: Map<string, number> = new Map<string, number>();
+
+  const coreInfo: Record<string, { keybinds?: (string | null)[] }> =
+    JSON.parse(wasmModule.FS.readFile(CORE_INFO_PATH, { encoding: "utf8" }));
+  const platform: { keybinds?: (string | null)[] } | undefined =
+    Object.values(coreInfo)[0];
+
+  platform?.keybinds?.forEach((key: string | null, button: number): void => {
+    if (key === null) {
+      return;
+    }
+    keys.set(NAMED_KEYS[key] ?? `Key${key}`, button);
+  });
+
+  return keys;
+}
+
+/*
+ * Run games dropped onto the target element and forward keyboard input
+ *
+ * Returns a function that stops listening and unloads the game, or null if
+ * the engine has no core.
+ */
+function startRetroGame(
+  wasmModule: object,
+  engine: object,
+  target: HTMLElement,
+): (() => void) | null {
+  if (!hasGameSource(engine)) {
+    return null;
+  }
+
+  const game: GameSource = engine;
+  const fsModule: FileSystemModule = wasmModule as FileSystemModule;
+  const keys: Map<string, number> = readKeybinds(fsModule);
+  const pressed: Set<number> = new Set<number>();
+
+  const onKey = (event: KeyboardEvent): void => {
+    const button: number | undefined = keys.get(event.code);
+    if (button === undefined) {
+      return;
+    }
+
+    // Keep keys like Tab from moving focus away from the game
+    event.preventDefault();
+
+    const down: boolean = event.type === "keydown";
+    if (down) {
+      pressed.add(button);
+    } else {
+      pressed.delete(button);
+    }
+    game.setButton(0, button, down);
+  };
+
+  // Release held buttons when key up events can no longer arrive
+  const onBlur = (): void => {
+    pressed.forEach((button: number): void => {
+      game.setButton(0, button, false);
+    });
+    pressed.clear();
+  };
+
+  const onDragOver = (event: DragEvent): void => {
+    event.preventDefault();
+  };
+
+  const onDrop = (event: DragEvent): void => {
+    event.preventDefault();
+
+    const file: File | undefined = event.dataTransfer?.files[0];
+    if (!file) {
+      return;
+    }
+
+    file
+      .arrayBuffer()
+      .then((data: ArrayBuffer): void => {
+        const fileName: string = file.name.replace(/\//g, "_");
+        const romPath: string = `${ROM_DIRECTORY}/${fileName}`;
+        fsModule.FS.writeFile(romPath, new Uint8Array(data));
+
+        if (!game.loadGame(romPath)) {
+          console.error(`Failed to load ${file.name}`);
+        }
+      })
+      .catch(console.error);
+  };
+
+  window.addEventListener("keydown", onKey);
+  window.addEventListener("keyup", onKey);
+  window.addEventListener("blur", onBlur);
+  target.addEventListener("dragover", onDragOver);
+  target.addEventListener("drop", onDrop);
+
+  return (): void => {
+    window.removeEventListener("keydown", onKey);
+    window.removeEventListener("keyup", onKey);
+    window.removeEventListener("blur", onBlur);
+    target.removeEventListener("dragover", onDragOver);
+    target.removeEventListener("drop", onDrop);
+
+    game.unloadGame();
+  };
+}
+
+export { startRetroGame };
@@ -9,10 +9,23 @@
 import react from "@vitejs/plugin-react";
 import { defineConfig } from "vite";
 
+// SharedArrayBuffer, which backs the emulation thread's memory, is only
+// available to cross-origin isolated pages
+const crossOriginIsolationHeaders = {
+  "Cross-Origin-Opener-Policy": "same-origin",
+  "Cross-Origin-Embedder-Policy": "require-corp",
+};
+
 // https://vitejs.dev/config/
 export default defineConfig({
   plugins: [
     react(),
     // Other plugins
   ],
+  server: {
+    headers: crossOriginIsolationHeaders,
+  },
+  preview: {
+    headers: crossOriginIsolationHeaders,
+  },
 });
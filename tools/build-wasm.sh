@@ -64,16 +64,27 @@ source "${EMSDK_DIRECTORY}/emsdk_env.sh"
 # Call CMake
 ################################################################################
 
-cd "${BUILD_DIRECTORY}"
-
-emcmake cmake \
-  "${ENGINE_DIRECTORY}" \
-  -DCMAKE_INSTALL_PREFIX="${OUTPUT_DIRECTORY}" \
-  $(! command -v ccache &> /dev/null || echo "-DCMAKE_CXX_COMPILER_LAUNCHER=ccache")
-
-cmake \
-  --build "${BUILD_DIRECTORY}" \
-  --target install
+# Build a baseline engine and an engine using WebAssembly SIMD. The frontend
+# loads the SIMD build when the browser supports it.
+for SIMD in OFF ON; do
+  VARIANT_BUILD_DIRECTORY="${BUILD_DIRECTORY}/simd-${SIMD}"
+  mkdir -p "${VARIANT_BUILD_DIRECTORY}"
+  cd "${VARIANT_BUILD_DIRECTORY}"
+
+  # Set RETRO_CORE to a platform in openai/cores (e.g. "nes") to link that core
+  # into the engine. This also requires an Emscripten build of Lua 5.1 on
+  # CMAKE_PREFIX_PATH.
+  emcmake cmake \
+    "${ENGINE_DIRECTORY}" \
+    -DCMAKE_INSTALL_PREFIX="${OUTPUT_DIRECTORY}" \
+    -DRETRO_CORE="${RETRO_CORE:-}" \
+    -DRETRO_ENGINE_SIMD="${SIMD}" \
+    $(! command -v ccache &> /dev/null || echo "-DCMAKE_CXX_COMPILER_LAUNCHER=ccache")
+
+  cmake \
+    --build "${VARIANT_BUILD_DIRECTORY}" \
+    --target install
+done
 
 # Copy the generated WASM files to the public directory
 cp -rv "${OUTPUT_DIRECTORY}/wasm"/*.wasm* "${WASM_DIRECTORY}"